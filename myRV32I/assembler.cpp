@@ -1,1078 +1,7977 @@
-#include <iostream>
-#include <fstream>
-#include <sstream>
-#include <string>
-#include <vector>
-#include <unordered_map>
-#include <regex>
-#include <cstdint>
-#include <iomanip>
-#include <bitset>
-
-class Instruction {
-public:
-    std::string label;
-    std::string opcode;
-    std::vector<std::string> operands;
-    
-    Instruction() {}
-    
-    Instruction(std::string label, std::string opcode, std::vector<std::string> operands)
-        : label(label), opcode(opcode), operands(operands) {}
-        
-    void print() const {
-        std::cout << "Label: " << (label.empty() ? "(nenhum)" : label) << std::endl;
-        std::cout << "Opcode: " << (opcode.empty() ? "(nenhum)" : opcode) << std::endl;
-        std::cout << "Operandos: ";
-        if (operands.empty()) {
-            std::cout << "(nenhum)";
-        } else {
-            for (size_t i = 0; i < operands.size(); ++i) {
-                std::cout << operands[i];
-                if (i < operands.size() - 1) {
-                    std::cout << ", ";
-                }
-            }
-        }
-        std::cout << std::endl;
-    }
-};
-
-enum InstructionType {
-    R_TYPE,
-    I_TYPE,
-    S_TYPE,
-    B_TYPE,
-    U_TYPE,
-    J_TYPE,
-    UNKNOWN
-};
-
-class Assembler {
-private:
-    std::string inputFile;
-    std::string outputFile;
-    std::vector<Instruction> instructions;
-    std::unordered_map<std::string, int> symbolTable;
-    std::unordered_map<std::string, std::unordered_map<std::string, int>> registerTable;
-    std::unordered_map<std::string, std::pair<InstructionType, std::string>> opcodeTable;
-    bool debugMode;  
-    
-    // Função para inicializar a tabela de registradores
-    void initRegisterTable() {
-        registerTable["x"] = {};
-        for (int i = 0; i < 32; i++) {
-            registerTable["x"][std::to_string(i)] = i;
-        }
-        registerTable["zero"] = {{"", 0}};
-        registerTable["ra"] = {{"", 1}};
-        registerTable["sp"] = {{"", 2}};
-        registerTable["gp"] = {{"", 3}};
-        registerTable["tp"] = {{"", 4}};
-        
-        registerTable["t"] = {};
-        for (int i = 0; i <= 2; i++) {
-            registerTable["t"][std::to_string(i)] = i + 5;
-        }
-        for (int i = 3; i <= 6; i++) {
-            registerTable["t"][std::to_string(i)] = i + 25;
-        }
-        
-        registerTable["s"] = {};
-        registerTable["s"]["0"] = 8;
-        registerTable["s"]["1"] = 9;
-        for (int i = 2; i <= 11; i++) {
-            registerTable["s"][std::to_string(i)] = i + 16;
-        }
-        
-        registerTable["a"] = {};
-        for (int i = 0; i <= 7; i++) {
-            registerTable["a"][std::to_string(i)] = i + 10;
-        }
-        
-        registerTable["fp"] = {{"", 8}}; 
-    }
-    
-    // Função para inicializar a tabela de opcodes
-    void initOpcodeTable() {
-        // Instruções tipo R
-        opcodeTable["add"] = {R_TYPE, "0110011"};
-        opcodeTable["sub"] = {R_TYPE, "0110011"};
-        opcodeTable["sll"] = {R_TYPE, "0110011"};
-        opcodeTable["slt"] = {R_TYPE, "0110011"};
-        opcodeTable["sltu"] = {R_TYPE, "0110011"};
-        opcodeTable["xor"] = {R_TYPE, "0110011"};
-        opcodeTable["srl"] = {R_TYPE, "0110011"};
-        opcodeTable["sra"] = {R_TYPE, "0110011"};
-        opcodeTable["or"] = {R_TYPE, "0110011"};
-        opcodeTable["and"] = {R_TYPE, "0110011"};
-        
-        // Instruções M de multiplicação (tipo R)
-        opcodeTable["mul"] = {R_TYPE, "0110011"};
-        opcodeTable["mulh"] = {R_TYPE, "0110011"};
-        opcodeTable["mulhsu"] = {R_TYPE, "0110011"};
-        opcodeTable["mulhu"] = {R_TYPE, "0110011"};
-        opcodeTable["div"] = {R_TYPE, "0110011"};
-        opcodeTable["divu"] = {R_TYPE, "0110011"};
-        opcodeTable["rem"] = {R_TYPE, "0110011"};
-        opcodeTable["remu"] = {R_TYPE, "0110011"};
-        
-        // Instruções tipo I
-        opcodeTable["addi"] = {I_TYPE, "0010011"};
-        opcodeTable["slti"] = {I_TYPE, "0010011"};
-        opcodeTable["sltiu"] = {I_TYPE, "0010011"};
-        opcodeTable["xori"] = {I_TYPE, "0010011"};
-        opcodeTable["ori"] = {I_TYPE, "0010011"};
-        opcodeTable["andi"] = {I_TYPE, "0010011"};
-        opcodeTable["slli"] = {I_TYPE, "0010011"};
-        opcodeTable["srli"] = {I_TYPE, "0010011"};
-        opcodeTable["srai"] = {I_TYPE, "0010011"};
-        
-        // Load (tipo I)
-        opcodeTable["lb"] = {I_TYPE, "0000011"};
-        opcodeTable["lh"] = {I_TYPE, "0000011"};
-        opcodeTable["lw"] = {I_TYPE, "0000011"};
-        opcodeTable["lbu"] = {I_TYPE, "0000011"};
-        opcodeTable["lhu"] = {I_TYPE, "0000011"};
-        
-        // Instruções tipo S
-        opcodeTable["sb"] = {S_TYPE, "0100011"};
-        opcodeTable["sh"] = {S_TYPE, "0100011"};
-        opcodeTable["sw"] = {S_TYPE, "0100011"};
-        
-        // Instruções tipo B
-        opcodeTable["beq"] = {B_TYPE, "1100011"};
-        opcodeTable["bne"] = {B_TYPE, "1100011"};
-        opcodeTable["blt"] = {B_TYPE, "1100011"};
-        opcodeTable["bge"] = {B_TYPE, "1100011"};
-        opcodeTable["bltu"] = {B_TYPE, "1100011"};
-        opcodeTable["bgeu"] = {B_TYPE, "1100011"};
-        
-        // Instruções tipo U
-        opcodeTable["lui"] = {U_TYPE, "0110111"};
-        opcodeTable["auipc"] = {U_TYPE, "0010111"};
-        
-        // Instruções tipo J
-        opcodeTable["jal"] = {J_TYPE, "1101111"};
-        
-        // JALR (tipo I)
-        opcodeTable["jalr"] = {I_TYPE, "1100111"};
-    }
-    
-    // Função para converter uma string de registrador para seu número
-    int getRegisterNumber(const std::string& reg) {
-        if (reg == "zero") return 0;
-        
-        // Verificar se é x0-x31
-        std::regex xreg("x([0-9]+)");
-        std::smatch match;
-        if (std::regex_match(reg, match, xreg)) {
-            int num = std::stoi(match[1]);
-            if (num >= 0 && num < 32) {
-                return num;
-            }
-        }
-        
-        // Verificar outros formatos de registradores (t0, a0, s0, etc.)
-        char prefix = reg[0];
-        if (reg.size() > 1 && registerTable.find(std::string(1, prefix)) != registerTable.end()) {
-            std::string suffix = reg.substr(1);
-            if (registerTable[std::string(1, prefix)].find(suffix) != registerTable[std::string(1, prefix)].end()) {
-                return registerTable[std::string(1, prefix)][suffix];
-            }
-        }
-        
-        if (registerTable.find(reg) != registerTable.end() && registerTable[reg].find("") != registerTable[reg].end()) {
-            return registerTable[reg][""];
-        }
-        
-        std::cerr << "Erro: Registrador desconhecido: " << reg << std::endl;
-        return -1;
-    }
-    
-    std::string cleanLine(const std::string& line) {
-        // Remover comentários
-        size_t commentPos = line.find('#');
-        std::string cleanedLine = (commentPos != std::string::npos) ? line.substr(0, commentPos) : line;
-        
-        // Remover espaços extras no início e fim
-        cleanedLine = std::regex_replace(cleanedLine, std::regex("^\\s+|\\s+$"), "");
-        
-        return cleanedLine;
-    }
-    
-    // Função para analisar uma linha de código assembly e lidar com pseudoinstruções
-    Instruction parseLine(const std::string& line) {
-        std::string cleanedLine = cleanLine(line);
-        if (cleanedLine.empty()) {
-            return Instruction("", "", {});
-        }
-        
-        std::string label = "";
-        std::string opcode = "";
-        std::vector<std::string> operands;
-        
-        // Verificar se há rótulo
-        size_t labelPos = cleanedLine.find(':');
-        if (labelPos != std::string::npos) {
-            label = cleanedLine.substr(0, labelPos);
-            label = std::regex_replace(label, std::regex("^\\s+|\\s+$"), "");
-            cleanedLine = cleanedLine.substr(labelPos + 1);
-            cleanedLine = std::regex_replace(cleanedLine, std::regex("^\\s+"), "");
-        }
-        
-        // Se após remover o rótulo a linha estiver vazia retornar
-        if (cleanedLine.empty()) {
-            return Instruction(label, "", {});
-        }
-        
-        // Analisar o opcode e operandos
-        std::istringstream ss(cleanedLine);
-        ss >> opcode;
-        
-        // Resto da linha são os operandos
-        std::string operandsStr;
-        std::getline(ss, operandsStr);
-        operandsStr = std::regex_replace(operandsStr, std::regex("^\\s+"), "");
-        
-        // Para instruções de load/store, o formato pode ser "lw rd, offset(rs1)"
-        if (opcode == "lb" || opcode == "lh" || opcode == "lw" || opcode == "lbu" || opcode == "lhu" ||
-            opcode == "sb" || opcode == "sh" || opcode == "sw") {
-            
-            // Dividir no primeiro operando
-            size_t commaPos = operandsStr.find(',');
-            if (commaPos != std::string::npos) {
-                std::string firstOp = operandsStr.substr(0, commaPos);
-                firstOp = std::regex_replace(firstOp, std::regex("^\\s+|\\s+$"), "");
-                operands.push_back(firstOp);
-                
-                std::string secondOp = operandsStr.substr(commaPos + 1);
-                secondOp = std::regex_replace(secondOp, std::regex("^\\s+|\\s+$"), "");
-                operands.push_back(secondOp);
-            }
-        } else {
-            // Dividir operandos por vírgula
-            std::istringstream operandStream(operandsStr);
-            std::string operand;
-            while (std::getline(operandStream, operand, ',')) {
-                operand = std::regex_replace(operand, std::regex("^\\s+|\\s+$"), "");
-                if (!operand.empty()) {
-                    operands.push_back(operand);
-                }
-            }
-        }
-        
-        // Lidar com pseudoinstruções
-        if (opcode == "j") {
-            // "j label" é uma pseudoinstrução para "jal zero, label"
-            if (operands.size() == 1) {
-                opcode = "jal";
-                operands.insert(operands.begin(), "zero");
-            }
-        } else if (opcode == "jr") {
-            // "jr rs" é uma pseudoinstrução para "jalr zero, rs, 0"
-            if (operands.size() == 1) {
-                opcode = "jalr";
-                operands.insert(operands.begin(), "zero");
-                operands.push_back("0");
-            }
-        } else if (opcode == "mv") {
-            // "mv rd, rs" é uma pseudoinstrução para "addi rd, rs, 0"
-            if (operands.size() == 2) {
-                opcode = "addi";
-                operands.push_back("0");
-            }
-        } else if (opcode == "li") {
-            // "li rd, imm" é uma pseudoinstrução para "addi rd, zero, imm"
-            if (operands.size() == 2) {
-                opcode = "addi";
-                operands.insert(operands.begin() + 1, "zero");
-            }
-        } else if (opcode == "nop") {
-            // "nop" é uma pseudoinstrução para "addi zero, zero, 0"
-            opcode = "addi";
-            operands = {"zero", "zero", "0"};
-        } else if (opcode == "bgt") {
-            // "bgt rs1, rs2, label" é uma pseudoinstrução para "blt rs2, rs1, label"
-            if (operands.size() == 3) {
-                opcode = "blt";
-                std::swap(operands[0], operands[1]);
-            }
-        } else if (opcode == "ble") {
-            // "ble rs1, rs2, label" é uma pseudoinstrução para "bge rs2, rs1, label"
-            if (operands.size() == 3) {
-                opcode = "bge";
-                std::swap(operands[0], operands[1]);
-            }
-        }
-        
-        return Instruction(label, opcode, operands);
-    }
-    
-    // Função para codificar instruções tipo R
-    std::string encodeRType(const Instruction& instr) {
-        // Formato: funct7[31:25] rs2[24:20] rs1[19:15] funct3[14:12] rd[11:7] opcode[6:0]
-        std::string binary = "";
-        std::string funct7 = "0000000"; // padrão
-        std::string funct3 = "000";     // padrão
-        
-        // Determinar funct7 com base no opcode
-        if (instr.opcode == "sub" || instr.opcode == "sra") {
-            funct7 = "0100000";
-        } else if (instr.opcode == "mul" || instr.opcode == "mulh" || 
-                   instr.opcode == "mulhsu" || instr.opcode == "mulhu" ||
-                   instr.opcode == "div" || instr.opcode == "divu" ||
-                   instr.opcode == "rem" || instr.opcode == "remu") {
-            funct7 = "0000001";  // Extensão M (multiplicação/divisão)
-        }
-        
-        // Determinar funct3 com base no opcode
-        if (instr.opcode == "add" || instr.opcode == "sub" || instr.opcode == "mul") funct3 = "000";
-        else if (instr.opcode == "sll" || instr.opcode == "mulh") funct3 = "001";
-        else if (instr.opcode == "slt" || instr.opcode == "mulhsu") funct3 = "010";
-        else if (instr.opcode == "sltu" || instr.opcode == "mulhu") funct3 = "011";
-        else if (instr.opcode == "xor" || instr.opcode == "div") funct3 = "100";
-        else if (instr.opcode == "srl" || instr.opcode == "sra" || instr.opcode == "divu") funct3 = "101";
-        else if (instr.opcode == "or" || instr.opcode == "rem") funct3 = "110";
-        else if (instr.opcode == "and" || instr.opcode == "remu") funct3 = "111";
-        
-        // Obter números dos registradores
-        int rd = getRegisterNumber(instr.operands[0]);
-        int rs1 = getRegisterNumber(instr.operands[1]);
-        int rs2 = getRegisterNumber(instr.operands[2]);
-        
-        // Construir a instrução binária usando strings
-        binary += funct7;
-        binary += std::bitset<5>(rs2).to_string();
-        binary += std::bitset<5>(rs1).to_string();
-        binary += funct3;
-        binary += std::bitset<5>(rd).to_string();
-        binary += opcodeTable[instr.opcode].second;
-        
-        return binary;
-    }
-    
-    // Função para codificar instruções tipo I
-    std::string encodeIType(const Instruction& instr) {
-        // Formato: imm[11:0] rs1[19:15] funct3[14:12] rd[11:7] opcode[6:0]
-        std::string binary = "";
-        std::string funct3 = "000";  // padrão
-        
-        // Determinar funct3 com base no opcode
-        if (instr.opcode == "addi") funct3 = "000";
-        else if (instr.opcode == "slti") funct3 = "010";
-        else if (instr.opcode == "sltiu") funct3 = "011";
-        else if (instr.opcode == "xori") funct3 = "100";
-        else if (instr.opcode == "ori") funct3 = "110";
-        else if (instr.opcode == "andi") funct3 = "111";
-        else if (instr.opcode == "slli") funct3 = "001";
-        else if (instr.opcode == "srli" || instr.opcode == "srai") funct3 = "101";
-        else if (instr.opcode == "lb") funct3 = "000";
-        else if (instr.opcode == "lh") funct3 = "001";
-        else if (instr.opcode == "lw") funct3 = "010";
-        else if (instr.opcode == "lbu") funct3 = "100";
-        else if (instr.opcode == "lhu") funct3 = "101";
-        else if (instr.opcode == "jalr") funct3 = "000";
-        
-        // Obter números dos registradores
-        int rd = getRegisterNumber(instr.operands[0]);
-        int rs1 = 0;
-        int imm = 0;
-        
-        // Analisar o formato específico da instrução
-        if (instr.opcode == "jalr" || 
-            instr.opcode == "lb" || instr.opcode == "lh" || instr.opcode == "lw" || 
-            instr.opcode == "lbu" || instr.opcode == "lhu") {
-            
-            // Formato: lw rd, imm(rs1)
-            std::string secondOp = instr.operands[1];
-            size_t openParen = secondOp.find('(');
-            size_t closeParen = secondOp.find(')');
-            
-            if (openParen != std::string::npos && closeParen != std::string::npos) {
-                std::string immStr = secondOp.substr(0, openParen);
-                std::string rs1Str = secondOp.substr(openParen + 1, closeParen - openParen - 1);
-                
-                // Converter para números
-                imm = std::stoi(immStr);
-                rs1 = getRegisterNumber(rs1Str);
-            } else if (instr.opcode == "jalr") {
-                // Formatos alternativos para jalr
-                if (instr.operands.size() == 2) {
-                    // jalr rd, rs1
-                    rs1 = getRegisterNumber(instr.operands[1]);
-                    imm = 0;
-                } else if (instr.operands.size() == 3) {
-                    // jalr rd, rs1, imm
-                    rs1 = getRegisterNumber(instr.operands[1]);
-                    try {
-                        imm = std::stoi(instr.operands[2]);
-                    } catch (const std::invalid_argument&) {
-                        if (symbolTable.find(instr.operands[2]) != symbolTable.end()) {
-                            imm = symbolTable[instr.operands[2]];
-                        } else {
-                            std::cerr << "Erro: Símbolo não encontrado: " << instr.operands[2] << std::endl;
-                            return "";
-                        }
-                    }
-                } else {
-                    std::cerr << "Erro: Formato inválido para instrução jalr" << std::endl;
-                    return "";
-                }
-            } else {
-                std::cerr << "Erro: Formato inválido para instrução de load: " << secondOp << std::endl;
-                return "";
-            }
-        } else {
-            // Formato normal: addi rd, rs1, imm
-            rs1 = getRegisterNumber(instr.operands[1]);
-            
-            // Verificar se o imediato é um número ou um símbolo
-            try {
-                imm = std::stoi(instr.operands[2]);
-            } catch (const std::invalid_argument&) {
-                // Se não for um número, deve ser um símbolo
-                if (symbolTable.find(instr.operands[2]) != symbolTable.end()) {
-                    imm = symbolTable[instr.operands[2]];
-                } else {
-                    std::cerr << "Erro: Símbolo não encontrado: " << instr.operands[2] << std::endl;
-                    return "";
-                }
-            }
-        }
-        
-        // Construir a instrução binária
-        std::string immBinary;
-        if (instr.opcode == "slli" || instr.opcode == "srli" || instr.opcode == "srai") {
-            // Para instruções de shift, os bits do imediato são diferentes
-            immBinary = (instr.opcode == "srai" ? "0100000" : "0000000") + std::bitset<5>(imm).to_string();
-        } else {
-            // Imediato de 12 bits com sinal
-            std::string immStr = std::bitset<12>(imm & 0xFFF).to_string();
-            immBinary = immStr;
-        }
-        
-        binary += immBinary;
-        binary += std::bitset<5>(rs1).to_string();
-        binary += funct3;
-        binary += std::bitset<5>(rd).to_string();
-        binary += opcodeTable[instr.opcode].second;
-        
-        return binary;
-    }
-    
-    // Função para codificar instruções tipo S
-    std::string encodeSType(const Instruction& instr) {
-        // Formato: imm[11:5] rs2[24:20] rs1[19:15] funct3[14:12] imm[4:0] opcode[6:0]
-        std::string binary = "";
-        std::string funct3 = "000";  // padrão
-        
-        // Determinar funct3 com base no opcode
-        if (instr.opcode == "sb") funct3 = "000";
-        else if (instr.opcode == "sh") funct3 = "001";
-        else if (instr.opcode == "sw") funct3 = "010";
-        
-        // Obter números dos registradores
-        int rs2 = getRegisterNumber(instr.operands[0]);
-        
-        // Formato: sw rs2, imm(rs1)
-        std::string secondOp = instr.operands[1];
-        size_t openParen = secondOp.find('(');
-        size_t closeParen = secondOp.find(')');
-        
-        int rs1, imm;
-        if (openParen != std::string::npos && closeParen != std::string::npos) {
-            std::string immStr = secondOp.substr(0, openParen);
-            std::string rs1Str = secondOp.substr(openParen + 1, closeParen - openParen - 1);
-            
-            // Converter para números
-            imm = std::stoi(immStr);
-            rs1 = getRegisterNumber(rs1Str);
-        } else {
-            std::cerr << "Erro: Formato inválido para instrução de store: " << secondOp << std::endl;
-            return "";
-        }
-        
-        // Construir a instrução binária
-        std::string immBinary = std::bitset<12>(imm).to_string();
-        
-        binary += immBinary.substr(0, 7);  // imm[11:5]
-        binary += std::bitset<5>(rs2).to_string();
-        binary += std::bitset<5>(rs1).to_string();
-        binary += funct3;
-        binary += immBinary.substr(7, 5);  // imm[4:0]
-        binary += opcodeTable[instr.opcode].second;
-        
-        return binary;
-    }
-    
-    // Função para codificar instruções tipo B
-    std::string encodeBType(const Instruction& instr) {
-        // Formato: imm[12|10:5] rs2[24:20] rs1[19:15] funct3[14:12] imm[4:1|11] opcode[6:0]
-        std::string binary = "";
-        std::string funct3 = "000";  // padrão
-        
-        // Determinar funct3 com base no opcode
-        if (instr.opcode == "beq") funct3 = "000";
-        else if (instr.opcode == "bne") funct3 = "001";
-        else if (instr.opcode == "blt") funct3 = "100";
-        else if (instr.opcode == "bge") funct3 = "101";
-        else if (instr.opcode == "bltu") funct3 = "110";
-        else if (instr.opcode == "bgeu") funct3 = "111";
-        
-        // Obter números dos registradores
-        int rs1 = getRegisterNumber(instr.operands[0]);
-        int rs2 = getRegisterNumber(instr.operands[1]);
-        
-        // Obter o imediato 
-        int imm = 0;
-        std::string labelName = instr.operands[2];
-        if (symbolTable.find(labelName) != symbolTable.end()) {
-            // calcula o offset relativo para o branch
-            int currentAddress = 0;
-            
-            // Encontrar o endereço da instrução atual
-            for (size_t i = 0; i < instructions.size(); i++) {
-                if (&instructions[i] == &instr) {
-                    break;
-                }
-                currentAddress += 4;  // Cada instrução ocupa 4 bytes
-            }
-            
-            int targetAddress = symbolTable[labelName];
-            // O offset é relativo ao PC da instrução atual
-            imm = targetAddress - currentAddress;
-            
-            // Para branch, o offset é dividido por 2 
-            // e deve ser múltiplo de 2
-            if (imm % 2 != 0) {
-                std::cerr << "Erro: Offset de branch não é múltiplo de 2: " << imm << std::endl;
-                return "";
-            }
-            imm = imm / 2;
-        } else {
-            try {
-                imm = std::stoi(labelName);
-            } catch (const std::invalid_argument&) {
-                std::cerr << "Erro: Rótulo não encontrado: " << labelName << std::endl;
-                return "";
-            }
-        }
-        
-        // Construir a instrução binária como string
-        // imm tem 13 bits com sinal (bit 0 é sempre 0)
-        std::string immBinary = std::bitset<13>(imm & 0x1FFF).to_string(); // 13 bits
-        
-        // Reorganizar os bits do imediato conforme o formato B
-        binary += immBinary[0];  // imm[12]
-        binary += immBinary.substr(2, 6);  // imm[10:5]
-        binary += std::bitset<5>(rs2).to_string();
-        binary += std::bitset<5>(rs1).to_string();
-        binary += funct3;
-        binary += immBinary.substr(8, 4);  // imm[4:1]
-        binary += immBinary[1];  // imm[11]
-        binary += opcodeTable[instr.opcode].second;
-        
-        return binary;
-    }
-    
-    // Função para codificar instruções tipo U
-    std::string encodeUType(const Instruction& instr) {
-        // Formato: imm[31:12] rd[11:7] opcode[6:0]
-        std::string binary = "";
-        
-        // Obter número do registrador
-        int rd = getRegisterNumber(instr.operands[0]);
-        
-        // Obter o imediato
-        int imm;
-        try {
-            imm = std::stoi(instr.operands[1]);
-        } catch (const std::invalid_argument&) {
-            // Se não for um número, deve ser um símbolo
-            if (symbolTable.find(instr.operands[1]) != symbolTable.end()) {
-                imm = symbolTable[instr.operands[1]];
-            } else {
-                std::cerr << "Erro: Símbolo não encontrado: " << instr.operands[1] << std::endl;
-                return "";
-            }
-        }
-        
-        // Construir a instrução binária
-        std::string immStr = std::bitset<20>(imm).to_string();
-        binary += immStr;
-        binary += std::bitset<5>(rd).to_string();
-        binary += opcodeTable[instr.opcode].second;
-        
-        return binary;
-    }
-    
-    // Função para codificar instruções tipo J
-    std::string encodeJType(const Instruction& instr) {
-        // Formato: imm[20|10:1|11|19:12] rd[11:7] opcode[6:0]
-        std::string binary = "";
-        
-        // Obter número do registrador
-        int rd = getRegisterNumber(instr.operands[0]);
-        
-        // Obter o imediato 
-        int imm = 0;
-        
-        // Verifica se o segundo operando é um rótulo ou um registrador
-        std::string target = instr.operands[1];
-        
-        if (symbolTable.find(target) != symbolTable.end()) {
-            // Calcula o offset relativo para o jump
-            int currentAddress = 0;
-            
-            // Encontrar o endereço da instrução atual
-            for (size_t i = 0; i < instructions.size(); i++) {
-                if (&instructions[i] == &instr) {
-                    break;
-                }
-                currentAddress += 4;  // Cada instrução ocupa 4 bytes
-            }
-            
-            int targetAddress = symbolTable[target];
-            imm = targetAddress - currentAddress;
-            
-            // Para JAL, o offset é dividido por 2 
-            // e deve ser múltiplo de 2
-            if (imm % 2 != 0) {
-                std::cerr << "Erro: Offset de JAL não é múltiplo de 2: " << imm << std::endl;
-                return "";
-            }
-            imm = imm / 2;
-        } else {
-            // Se não for um rótulo, tentar interpretar como um número
-            try {
-                imm = std::stoi(target);
-            } catch (const std::invalid_argument&) {
-                std::cerr << "Erro: Rótulo não encontrado: " << target << std::endl;
-                return "";
-            }
-        }
-        
-        // Construir a instrução binária
-        // Para JAL, imm tem 21 bits 
-        std::string immBinary = std::bitset<21>(imm & 0x1FFFFF).to_string(); // 21 bits
-        
-        // Reorganizar os bits do imediato conforme o formato J
-        binary += immBinary[0];  // imm[20]
-        binary += immBinary.substr(10, 10);  // imm[10:1]
-        binary += immBinary[9];  // imm[11]
-        binary += immBinary.substr(1, 8);  // imm[19:12]
-        binary += std::bitset<5>(rd).to_string();
-        binary += opcodeTable[instr.opcode].second;
-        
-        return binary;
-    }
-    
-    // Função para codificar uma instrução para binário
-    std::string encodeToBinary(const Instruction& instr) {
-        if (instr.opcode.empty()) {
-            return "";
-        }
-        
-        // Verificar se o opcode existe na tabela
-        if (opcodeTable.find(instr.opcode) == opcodeTable.end()) {
-            std::cerr << "Erro: Opcode desconhecido: " << instr.opcode << std::endl;
-            return "";
-        }
-        
-        // Verificar se há operandos suficientes
-        size_t minOperands = 0;
-        InstructionType type = opcodeTable[instr.opcode].first;
-        
-        switch (type) {
-            case R_TYPE:
-                minOperands = 3;  // rd, rs1, rs2
-                break;
-            case I_TYPE:
-                minOperands = (instr.opcode == "jalr") ? 2 : 3;  // rd, rs1, imm ou rd, offset
-                break;
-            case S_TYPE:
-                minOperands = 2;  // rs2, offset(rs1)
-                break;
-            case B_TYPE:
-                minOperands = 3;  // rs1, rs2, offset
-                break;
-            case U_TYPE:
-                minOperands = 2;  // rd, imm
-                break;
-            case J_TYPE:
-                minOperands = 2;  // rd, offset
-                break;
-            default:
-                break;
-        }
-        
-        if (instr.operands.size() < minOperands) {
-            std::cerr << "Erro: Número insuficiente de operandos para " << instr.opcode 
-                      << ". Esperado: " << minOperands << ", Encontrado: " << instr.operands.size() << std::endl;
-            return "";
-        }
-        
-        // Codificar de acordo com o tipo da instrução
-        std::string binary;
-        switch (type) {
-            case R_TYPE:
-                binary = encodeRType(instr);
-                break;
-            case I_TYPE:
-                binary = encodeIType(instr);
-                break;
-            case S_TYPE:
-                binary = encodeSType(instr);
-                break;
-            case B_TYPE:
-                binary = encodeBType(instr);
-                break;
-            case U_TYPE:
-                binary = encodeUType(instr);
-                break;
-            case J_TYPE:
-                binary = encodeJType(instr);
-                break;
-            default:
-                std::cerr << "Erro: Tipo de instrução desconhecido para " << instr.opcode << std::endl;
-                return "";
-        }
-        
-        // Verificar se a codificação foi bem-sucedida
-        if (binary.empty()) {
-            std::cerr << "Erro: Falha ao codificar a instrução: " << instr.opcode << std::endl;
-            return "";
-        }
-        
-        // Verificar se o comprimento do binário é 32 bits
-        if (binary.length() != 32) {
-            std::cerr << "Erro: Instrução codificada não tem 32 bits: " << binary.length() 
-                      << " bits para " << instr.opcode << std::endl;
-            return "";
-        }
-        
-        return binary;
-    }
-    
-    // Função para converter binário de 32 bits para formato little-endian binário (4 linhas de 8 bits)
-    std::vector<std::string> binaryToLittleEndianBinary(const std::string& binary) {
-        std::vector<std::string> result;
-        
-        if (binary.empty() || binary.length() != 32) {
-            return result;
-        }
-        
-        // Dividir em 4 bytes (8 bits cada) em formato little-endian
-        // Byte 0 (LSB): bits 7-0
-        result.push_back(binary.substr(24, 8));
-        // Byte 1: bits 15-8  
-        result.push_back(binary.substr(16, 8));
-        // Byte 2: bits 23-16
-        result.push_back(binary.substr(8, 8));
-        // Byte 3 (MSB): bits 31-24
-        result.push_back(binary.substr(0, 8));
-        
-        return result;
-    }
-    
-    // Função para verificar a sintaxe das instruções assembly
-    bool validateSyntax() {
-        bool isValid = true;
-        
-        for (size_t i = 0; i < instructions.size(); i++) {
-            const Instruction& instr = instructions[i];
-            
-            // Pular instruções vazias 
-            if (instr.opcode.empty()) {
-                continue;
-            }
-            
-            // Verificar se o opcode existe
-            if (opcodeTable.find(instr.opcode) == opcodeTable.end()) {
-                std::cerr << "Erro de sintaxe na linha " << (i + 1) << ": Opcode desconhecido '" << instr.opcode << "'" << std::endl;
-                isValid = false;
-                continue;
-            }
-            
-            // Verifica se há operandos suficientes
-            size_t minOperands = 0;
-            InstructionType type = opcodeTable[instr.opcode].first;
-            
-            switch (type) {
-                case R_TYPE:
-                    minOperands = 3;  // rd, rs1, rs2
-                    break;
-                case I_TYPE:
-                    if (instr.opcode == "jalr") {
-                        minOperands = 2;  // rd, rs1[, imm]
-                    } else if (instr.opcode.find("l") == 0) {  // Instruções load
-                        minOperands = 2;  // rd, offset(rs1)
-                    } else {
-                        minOperands = 3;  // rd, rs1, imm
-                    }
-                    break;
-                case S_TYPE:
-                    minOperands = 2;  // rs2, offset(rs1)
-                    break;
-                case B_TYPE:
-                    minOperands = 3;  // rs1, rs2, offset
-                    break;
-                case U_TYPE:
-                    minOperands = 2;  // rd, imm
-                    break;
-                case J_TYPE:
-                    minOperands = 2;  // rd, offset
-                    break;
-                default:
-                    break;
-            }
-            
-            if (instr.operands.size() < minOperands) {
-                std::cerr << "Erro de sintaxe na linha " << (i + 1) << ": Número insuficiente de operandos para '" 
-                          << instr.opcode << "'. Esperado: " << minOperands 
-                          << ", Encontrado: " << instr.operands.size() << std::endl;
-                isValid = false;
-                continue;
-            }
-            
-            // Verificar registradores válidos
-            for (size_t j = 0; j < instr.operands.size(); j++) {
-                const std::string& op = instr.operands[j];
-                
-                // Verifica apenas operandos que devem ser registradores
-                bool shouldBeRegister = false;
-                
-                switch (type) {
-                    case R_TYPE:
-                        shouldBeRegister = true;  // Todos os operandos são registradores
-                        break;
-                    case I_TYPE:
-                        if (j < 2) shouldBeRegister = true;  // rd, rs1 são registradores
-                        break;
-                    case S_TYPE:
-                        if (j == 0) shouldBeRegister = true;  // rs2 é registrador
-                        break;
-                    case B_TYPE:
-                        if (j < 2) shouldBeRegister = true;  // rs1, rs2 são registradores
-                        break;
-                    case U_TYPE:
-                    case J_TYPE:
-                        if (j == 0) shouldBeRegister = true;  // rd é registrador
-                        break;
-                    default:
-                        break;
-                }
-                
-                if (shouldBeRegister) {
-                    if (type == S_TYPE && j == 1) {
-                        size_t openParen = op.find('(');
-                        size_t closeParen = op.find(')');
-                        
-                        if (openParen != std::string::npos && closeParen != std::string::npos) {
-                            std::string rs1Str = op.substr(openParen + 1, closeParen - openParen - 1);
-                            if (getRegisterNumber(rs1Str) == -1) {
-                                std::cerr << "Erro de sintaxe na linha " << (i + 1) << ": Registrador inválido '" 
-                                          << rs1Str << "' em '" << op << "'" << std::endl;
-                                isValid = false;
-                            }
-                        } else {
-                            std::cerr << "Erro de sintaxe na linha " << (i + 1) << ": Formato inválido para instrução de store/load: '" 
-                                      << op << "', esperado formato 'offset(rs1)'" << std::endl;
-                            isValid = false;
-                        }
-                    } else {
-                        if (getRegisterNumber(op) == -1) {
-                            std::cerr << "Erro de sintaxe na linha " << (i + 1) << ": Registrador inválido '" << op << "'" << std::endl;
-                            isValid = false;
-                        }
-                    }
-                }
-            }
-            
-            // Verificações específicas para tipos de instrução
-            if (type == B_TYPE || type == J_TYPE) {
-                const std::string& label = instr.operands[instr.operands.size() - 1];
-                
-                bool isNumber = true;
-                try {
-                    std::stoi(label);
-                } catch (const std::invalid_argument&) {
-                    isNumber = false;
-                }
-                
-                if (!isNumber && symbolTable.find(label) == symbolTable.end()) {
-                    std::cerr << "Erro de sintaxe na linha " << (i + 1) << ": Rótulo não encontrado '" << label << "'" << std::endl;
-                    isValid = false;
-                }
-            }
-        }
-        
-        return isValid;
-    }
-
-public:
-    Assembler(const std::string& input, const std::string& output = "memoria.mif")
-        : inputFile(input), outputFile(output), debugMode(false) {
-    }
-    
-    void setDebugMode(bool enable) {
-        debugMode = enable;
-    }
-    
-    bool firstPass() {
-        std::ifstream file(inputFile);
-        if (!file.is_open()) {
-            std::cerr << "Erro: Não foi possível abrir o arquivo de entrada: " << inputFile << std::endl;
-            return false;
-        }
-        
-        std::string line;
-        int address = 0;
-        
-        while (std::getline(file, line)) {
-            Instruction instr = parseLine(line);
-            
-            // Se a instrução tiver um rótulo, registrar na tabela de símbolos
-            if (!instr.label.empty()) {
-                symbolTable[instr.label] = address;
-            }
-            
-            // Se a instrução tiver um opcode, incrementar o endereço
-            if (!instr.opcode.empty()) {
-                instructions.push_back(instr);
-                address += 4;  // Cada instrução ocupa 4 bytes
-            }
-        }
-        
-        file.close();
-        return true;
-    }
-    
-    bool secondPass() {
-        std::ofstream file(outputFile);
-        if (!file.is_open()) {
-            std::cerr << "Erro: Não foi possível abrir o arquivo de saída: " << outputFile << std::endl;
-            return false;
-        }
-        
-        for (size_t i = 0; i < instructions.size(); i++) {
-            Instruction& instr = instructions[i];
-            
-            if (debugMode) {
-                std::cout << "Instrução #" << i << " (Endereço: 0x" << std::hex << (i * 4) << std::dec << ")" << std::endl;
-                instr.print();
-            }
-            
-            if (instr.opcode.empty()) {
-                if (debugMode) {
-                    std::cout << "  (Instrução vazia, pulando)" << std::endl;
-                }
-                continue;
-            }
-            
-            std::string binary = encodeToBinary(instr);
-            if (!binary.empty()) {
-                std::vector<std::string> binaryBytes = binaryToLittleEndianBinary(binary);
-                if (!binaryBytes.empty()) {
-                    if (debugMode) {
-                        std::cout << "  Código binário: " << binary << std::endl;
-                        std::cout << "  Bytes (little-endian):" << std::endl;
-                        for (size_t j = 0; j < binaryBytes.size(); j++) {
-                            std::cout << "    Byte " << j << ": " << binaryBytes[j] << std::endl;
-                        }
-                        std::cout << "  Gravando no arquivo de saída" << std::endl;
-                        std::cout << std::endl;
-                    }
-                    
-                    // Escrever cada byte em uma linha separada (formato .mif especificado)
-                    for (const std::string& byteBinary : binaryBytes) {
-                        file << byteBinary << std::endl;
-                    }
-                } else {
-                    std::cerr << "Erro: Falha ao converter instrução para formato little-endian: " << instr.opcode << std::endl;
-                    file.close();
-                    return false;
-                }
-            } else {
-                std::cerr << "Erro: Falha ao codificar instrução: " << instr.opcode << std::endl;
-                file.close();
-                return false;
-            }
-        }
-        
-        file.close();
-        std::cout << "Montagem concluída com sucesso. Arquivo gerado: " << outputFile << std::endl;
-        return true;
-    }
-    
-    // Função principal para executar o montador
-    bool assemble() {
-        initRegisterTable();
-        initOpcodeTable();
-        
-        std::cout << "Iniciando a primeira passagem..." << std::endl;
-        if (!firstPass()) {
-            return false;
-        }
-        
-        std::cout << "Primeira passagem concluída. Símbolos encontrados: " << symbolTable.size() << std::endl;
-        
-        if (debugMode) {
-            std::cout << "Tabela de símbolos:" << std::endl;
-            for (const auto& symbol : symbolTable) {
-                std::cout << "  " << symbol.first << " = 0x" << std::hex << symbol.second << std::dec << std::endl;
-            }
-        }
-        
-        std::cout << "Validando sintaxe..." << std::endl;
-        if (!validateSyntax()) {
-            std::cerr << "Erros de sintaxe encontrados. Abortando." << std::endl;
-            return false;
-        }
-        
-        std::cout << "Sintaxe válida. Iniciando a segunda passagem..." << std::endl;
-        
-        if (!secondPass()) {
-            return false;
-        }
-        
-        return true;
-    }
-};
-
-int main(int argc, char* argv[]) {
-    if (argc < 2 || argc > 4) {
-        std::cerr << "Uso: " << argv[0] << " <arquivo_entrada.asm> [arquivo_saida.mif] [-d]" << std::endl;
-        std::cerr << "  -d: Habilita o modo de depuração (mostra informações detalhadas)" << std::endl;
-        return 1;
-    }
-    
-    std::string inputFile = argv[1];
-    std::string outputFile = "memoria.mif";
-    bool debugMode = false;
-    
-    for (int i = 2; i < argc; i++) {
-        std::string arg = argv[i];
-        if (arg == "-d") {
-            debugMode = true;
-        } else {
-            outputFile = arg;
-        }
-    }
-    
-    Assembler assembler(inputFile, outputFile);
-    
-    if (debugMode) {
-        std::cout << "Modo de depuração ativado" << std::endl;
-        assembler.setDebugMode(true);
-    }
-    
-    if (assembler.assemble()) {
-        std::cout << "Montagem concluída com sucesso! Arquivo gerado: " << outputFile << std::endl;
-        return 0;
-    } else {
-        std::cerr << "Erro durante o processo de montagem." << std::endl;
-        return 1;
-    }
-}
\ No newline at end of file
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <map>
+#include <set>
+#include <memory>
+#include <cstdint>
+#include <iomanip>
+#include <bitset>
+#include <chrono>
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <charconv>
+#include <deque>
+#include <condition_variable>
+#include <csignal>
+#include <cerrno>
+#include <cstdlib>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+class Instruction {
+public:
+    std::string label;
+    std::string opcode;
+    std::vector<std::string> operands;
+    int line;    // Linha do arquivo fonte (0 quando não vem de um arquivo)
+    int symbol;  // ID do operando simbólico na tabela de símbolos (-1 se não resolvido)
+    uint32_t address;  // Endereço atribuído na primeira passagem (.org pode criar lacunas)
+    uint32_t size;     // Bytes ocupados: 4, 2 na forma comprimida, 8 ou 12 num desvio relaxado
+    bool forceCompressed;  // Escrita como "c.<instrução>": exige a forma de 16 bits
+    std::string constant;  // li/la com rótulo: valor carregado pelo par lui/addi (ver expandConstantLoad)
+    
+    Instruction() : line(0), symbol(-1), address(0), size(4), forceCompressed(false) {}
+    
+    Instruction(std::string label, std::string opcode, std::vector<std::string> operands)
+        : label(label), opcode(opcode), operands(operands), line(0), symbol(-1), address(0),
+          size(4), forceCompressed(false) {}
+        
+    void print() const {
+        std::cout << "Linha: " << line << std::endl;
+        std::cout << "Label: " << (label.empty() ? "(nenhum)" : label) << std::endl;
+        std::cout << "Opcode: " << (opcode.empty() ? "(nenhum)" : opcode) << std::endl;
+        std::cout << "Operandos: ";
+        if (operands.empty()) {
+            std::cout << "(nenhum)";
+        } else {
+            for (size_t i = 0; i < operands.size(); ++i) {
+                std::cout << operands[i];
+                if (i < operands.size() - 1) {
+                    std::cout << ", ";
+                }
+            }
+        }
+        std::cout << std::endl;
+    }
+    
+    // Forma textual "opcode op1, op2, ..." (sem rótulo)
+    std::string toString() const {
+        std::string text = opcode;
+        for (size_t i = 0; i < operands.size(); ++i) {
+            text += (i == 0 ? " " : ", ") + operands[i];
+        }
+        return text;
+    }
+};
+
+enum InstructionType {
+    R_TYPE,
+    I_TYPE,
+    S_TYPE,
+    B_TYPE,
+    U_TYPE,
+    J_TYPE,
+    UNKNOWN
+};
+
+// Descritor de instrução: formato e campos fixos da codificação.
+// Compartilhado pelos codificadores do montador e pelo desmontador.
+struct InstructionDescriptor {
+    std::string mnemonic;
+    InstructionType type;
+    std::string opcode;  // bits [6:0]
+    std::string funct3;  // bits [14:12], vazio quando o formato não possui funct3
+    std::string funct7;  // bits [31:25], vazio quando o formato não possui funct7
+};
+
+static const InstructionDescriptor INSTRUCTION_DESCRIPTORS[] = {
+    // Instruções tipo R
+    {"add",    R_TYPE, "0110011", "000", "0000000"},
+    {"sub",    R_TYPE, "0110011", "000", "0100000"},
+    {"sll",    R_TYPE, "0110011", "001", "0000000"},
+    {"slt",    R_TYPE, "0110011", "010", "0000000"},
+    {"sltu",   R_TYPE, "0110011", "011", "0000000"},
+    {"xor",    R_TYPE, "0110011", "100", "0000000"},
+    {"srl",    R_TYPE, "0110011", "101", "0000000"},
+    {"sra",    R_TYPE, "0110011", "101", "0100000"},
+    {"or",     R_TYPE, "0110011", "110", "0000000"},
+    {"and",    R_TYPE, "0110011", "111", "0000000"},
+    
+    // Instruções M de multiplicação (tipo R)
+    {"mul",    R_TYPE, "0110011", "000", "0000001"},
+    {"mulh",   R_TYPE, "0110011", "001", "0000001"},
+    {"mulhsu", R_TYPE, "0110011", "010", "0000001"},
+    {"mulhu",  R_TYPE, "0110011", "011", "0000001"},
+    {"div",    R_TYPE, "0110011", "100", "0000001"},
+    {"divu",   R_TYPE, "0110011", "101", "0000001"},
+    {"rem",    R_TYPE, "0110011", "110", "0000001"},
+    {"remu",   R_TYPE, "0110011", "111", "0000001"},
+    
+    // Instruções tipo I (shifts usam funct7 nos bits altos do imediato)
+    {"addi",   I_TYPE, "0010011", "000", ""},
+    {"slti",   I_TYPE, "0010011", "010", ""},
+    {"sltiu",  I_TYPE, "0010011", "011", ""},
+    {"xori",   I_TYPE, "0010011", "100", ""},
+    {"ori",    I_TYPE, "0010011", "110", ""},
+    {"andi",   I_TYPE, "0010011", "111", ""},
+    {"slli",   I_TYPE, "0010011", "001", "0000000"},
+    {"srli",   I_TYPE, "0010011", "101", "0000000"},
+    {"srai",   I_TYPE, "0010011", "101", "0100000"},
+    
+    // Load (tipo I)
+    {"lb",     I_TYPE, "0000011", "000", ""},
+    {"lh",     I_TYPE, "0000011", "001", ""},
+    {"lw",     I_TYPE, "0000011", "010", ""},
+    {"lbu",    I_TYPE, "0000011", "100", ""},
+    {"lhu",    I_TYPE, "0000011", "101", ""},
+    
+    // Instruções tipo S
+    {"sb",     S_TYPE, "0100011", "000", ""},
+    {"sh",     S_TYPE, "0100011", "001", ""},
+    {"sw",     S_TYPE, "0100011", "010", ""},
+    
+    // Instruções tipo B
+    {"beq",    B_TYPE, "1100011", "000", ""},
+    {"bne",    B_TYPE, "1100011", "001", ""},
+    {"blt",    B_TYPE, "1100011", "100", ""},
+    {"bge",    B_TYPE, "1100011", "101", ""},
+    {"bltu",   B_TYPE, "1100011", "110", ""},
+    {"bgeu",   B_TYPE, "1100011", "111", ""},
+    
+    // Instruções tipo U
+    {"lui",    U_TYPE, "0110111", "", ""},
+    {"auipc",  U_TYPE, "0010111", "", ""},
+    
+    // Instruções tipo J
+    {"jal",    J_TYPE, "1101111", "", ""},
+    
+    // JALR (tipo I)
+    {"jalr",   I_TYPE, "1100111", "000", ""}
+};
+
+static const size_t INSTRUCTION_DESCRIPTOR_COUNT =
+    sizeof(INSTRUCTION_DESCRIPTORS) / sizeof(INSTRUCTION_DESCRIPTORS[0]);
+
+// Nomes ABI dos registradores, indexados pelo número do registrador
+static const char* const ABI_REGISTER_NAMES[32] = {
+    "zero", "ra", "sp", "gp", "tp", "t0", "t1", "t2",
+    "s0", "s1", "a0", "a1", "a2", "a3", "a4", "a5",
+    "a6", "a7", "s2", "s3", "s4", "s5", "s6", "s7",
+    "s8", "s9", "s10", "s11", "t3", "t4", "t5", "t6"
+};
+
+// Codificação comprimida de 16 bits (subconjunto inteiro do RV32C). Cada forma
+// comprimida é definida pela instrução de 32 bits equivalente, então o montador
+// comprime a palavra já codificada e o simulador e o desmontador expandem a
+// meia palavra de volta antes de decodificar.
+struct CompressedCodec {
+    // Registradores acessíveis pelos campos de 3 bits (x8..x15)
+    static bool isCompact(uint32_t reg) {
+        return reg >= 8 && reg <= 15;
+    }
+    
+    static bool fitsSigned(int32_t value, int bits) {
+        return value >= -(1 << (bits - 1)) && value < (1 << (bits - 1));
+    }
+    
+    // Campo de offset de c.j/c.jal: imm[11|4|9:8|10|6|7|3:1|5] em [12:2]
+    static uint32_t jumpField(int32_t offset) {
+        uint32_t imm = static_cast<uint32_t>(offset);
+        return (((imm >> 11) & 1) << 12) | (((imm >> 4) & 1) << 11) | (((imm >> 8) & 3) << 9) |
+               (((imm >> 10) & 1) << 8) | (((imm >> 6) & 1) << 7) | (((imm >> 7) & 1) << 6) |
+               (((imm >> 1) & 7) << 3) | (((imm >> 5) & 1) << 2);
+    }
+    
+    // Campo de offset de c.beqz/c.bnez: imm[8|4:3] em [12:10], imm[7:6|2:1|5] em [6:2]
+    static uint32_t branchField(int32_t offset) {
+        uint32_t imm = static_cast<uint32_t>(offset);
+        return (((imm >> 8) & 1) << 12) | (((imm >> 3) & 3) << 10) | (((imm >> 6) & 3) << 5) |
+               (((imm >> 1) & 3) << 3) | (((imm >> 5) & 1) << 2);
+    }
+    
+    // Imediato de 6 bits com sinal em [12] e [6:2]
+    static uint32_t smallField(int32_t value) {
+        uint32_t imm = static_cast<uint32_t>(value);
+        return (((imm >> 5) & 1) << 12) | ((imm & 0x1F) << 2);
+    }
+    
+    // Procura a forma comprimida da palavra. Além das expansões exatas, aceita
+    // "addi rd, rs, 0" como c.mv (que expande para "add rd, zero, rs").
+    static bool compress(uint32_t word, uint16_t& half) {
+        uint32_t opcode = word & 0x7F;
+        uint32_t rd = (word >> 7) & 0x1F;
+        uint32_t funct3 = (word >> 12) & 0x7;
+        uint32_t rs1 = (word >> 15) & 0x1F;
+        uint32_t rs2 = (word >> 20) & 0x1F;
+        uint32_t funct7 = word >> 25;
+        int32_t immI = static_cast<int32_t>(word) >> 20;
+        int32_t immS = (static_cast<int32_t>(word & 0xFE000000) >> 20) | ((word >> 7) & 0x1F);
+        int32_t immB = (static_cast<int32_t>(word & 0x80000000) >> 19) | ((word & 0x80) << 4) |
+                       ((word >> 20) & 0x7E0) | ((word >> 7) & 0x1E);
+        int32_t immJ = (static_cast<int32_t>(word & 0x80000000) >> 11) | (word & 0xFF000) |
+                       ((word >> 9) & 0x800) | ((word >> 20) & 0x7FE);
+        uint32_t c = 0;
+        
+        switch (opcode) {
+            case 0x13:  // addi, slli, srli, srai, andi
+                if (funct3 == 0) {
+                    if (rd == 0 && rs1 == 0 && immI == 0) {
+                        c = 0x0001;  // c.nop
+                    } else if (rd != 0 && rs1 == 0 && fitsSigned(immI, 6)) {
+                        c = 0x4001 | (rd << 7) | smallField(immI);  // c.li
+                    } else if (rd != 0 && rd == rs1 && immI != 0 && fitsSigned(immI, 6)) {
+                        c = 0x0001 | (rd << 7) | smallField(immI);  // c.addi
+                    } else if (rd == 2 && rs1 == 2 && immI != 0 && immI % 16 == 0 && fitsSigned(immI, 10)) {
+                        uint32_t imm = static_cast<uint32_t>(immI);
+                        c = 0x6101 | (((imm >> 9) & 1) << 12) | (((imm >> 4) & 1) << 6) |
+                            (((imm >> 6) & 1) << 5) | (((imm >> 7) & 3) << 3) | (((imm >> 5) & 1) << 2);  // c.addi16sp
+                    } else if (isCompact(rd) && rs1 == 2 && immI > 0 && immI % 4 == 0 && immI < 1024) {
+                        uint32_t imm = static_cast<uint32_t>(immI);
+                        c = 0x0000 | (((imm >> 4) & 3) << 11) | (((imm >> 6) & 0xF) << 7) |
+                            (((imm >> 2) & 1) << 6) | (((imm >> 3) & 1) << 5) | ((rd - 8) << 2);  // c.addi4spn
+                    } else if (rd != 0 && rs1 != 0 && immI == 0) {
+                        c = 0x8002 | (rd << 7) | (rs1 << 2);  // c.mv
+                    } else {
+                        return false;
+                    }
+                } else if (funct3 == 1 && funct7 == 0 && rd != 0 && rd == rs1 && rs2 != 0) {
+                    c = 0x0002 | (rd << 7) | (rs2 << 2);  // c.slli
+                } else if (funct3 == 5 && (funct7 == 0 || funct7 == 0x20) && isCompact(rd) && rd == rs1 && rs2 != 0) {
+                    c = 0x8001 | ((funct7 == 0x20 ? 1u : 0u) << 10) | ((rd - 8) << 7) | (rs2 << 2);  // c.srli/c.srai
+                } else if (funct3 == 7 && isCompact(rd) && rd == rs1 && fitsSigned(immI, 6)) {
+                    c = 0x8801 | ((rd - 8) << 7) | smallField(immI);  // c.andi
+                } else {
+                    return false;
+                }
+                break;
+            case 0x33:  // add, sub, xor, or, and
+                if (funct7 == 0 && funct3 == 0 && rd != 0 && rs1 == 0 && rs2 != 0) {
+                    c = 0x8002 | (rd << 7) | (rs2 << 2);  // c.mv
+                } else if (funct7 == 0 && funct3 == 0 && rd != 0 && rd == rs1 && rs2 != 0) {
+                    c = 0x9002 | (rd << 7) | (rs2 << 2);  // c.add
+                } else if (isCompact(rd) && rd == rs1 && isCompact(rs2) &&
+                           ((funct7 == 0x20 && funct3 == 0) || (funct7 == 0 && (funct3 == 4 || funct3 == 6 || funct3 == 7)))) {
+                    uint32_t op = (funct7 == 0x20) ? 0 : (funct3 == 4) ? 1 : (funct3 == 6) ? 2 : 3;
+                    c = 0x8C01 | ((rd - 8) << 7) | (op << 5) | ((rs2 - 8) << 2);  // c.sub/c.xor/c.or/c.and
+                } else {
+                    return false;
+                }
+                break;
+            case 0x37: {  // lui
+                int32_t imm = static_cast<int32_t>(word) >> 12;
+                if (rd == 0 || rd == 2 || imm == 0 || !fitsSigned(imm, 6)) {
+                    return false;
+                }
+                c = 0x6001 | (rd << 7) | smallField(imm);  // c.lui
+                break;
+            }
+            case 0x03:  // lw
+                if (funct3 != 2 || immI < 0 || immI % 4 != 0) {
+                    return false;
+                }
+                if (rs1 == 2 && rd != 0 && immI < 256) {
+                    uint32_t imm = static_cast<uint32_t>(immI);
+                    c = 0x4002 | (((imm >> 5) & 1) << 12) | (rd << 7) | (((imm >> 2) & 7) << 4) |
+                        (((imm >> 6) & 3) << 2);  // c.lwsp
+                } else if (isCompact(rd) && isCompact(rs1) && immI < 128) {
+                    uint32_t imm = static_cast<uint32_t>(immI);
+                    c = 0x4000 | (((imm >> 3) & 7) << 10) | ((rs1 - 8) << 7) | (((imm >> 2) & 1) << 6) |
+                        (((imm >> 6) & 1) << 5) | ((rd - 8) << 2);  // c.lw
+                } else {
+                    return false;
+                }
+                break;
+            case 0x23:  // sw
+                if (funct3 != 2 || immS < 0 || immS % 4 != 0) {
+                    return false;
+                }
+                if (rs1 == 2 && immS < 256) {
+                    uint32_t imm = static_cast<uint32_t>(immS);
+                    c = 0xC002 | (((imm >> 2) & 0xF) << 9) | (((imm >> 6) & 3) << 7) | (rs2 << 2);  // c.swsp
+                } else if (isCompact(rs1) && isCompact(rs2) && immS < 128) {
+                    uint32_t imm = static_cast<uint32_t>(immS);
+                    c = 0xC000 | (((imm >> 3) & 7) << 10) | ((rs1 - 8) << 7) | (((imm >> 2) & 1) << 6) |
+                        (((imm >> 6) & 1) << 5) | ((rs2 - 8) << 2);  // c.sw
+                } else {
+                    return false;
+                }
+                break;
+            case 0x63:  // beq/bne com zero
+                if ((funct3 != 0 && funct3 != 1) || rs2 != 0 || !isCompact(rs1) || !fitsSigned(immB, 9)) {
+                    return false;
+                }
+                c = (funct3 == 0 ? 0xC001 : 0xE001) | ((rs1 - 8) << 7) | branchField(immB);  // c.beqz/c.bnez
+                break;
+            case 0x6F:  // jal zero / jal ra
+                if ((rd != 0 && rd != 1) || !fitsSigned(immJ, 12)) {
+                    return false;
+                }
+                c = (rd == 0 ? 0xA001 : 0x2001) | jumpField(immJ);  // c.j/c.jal
+                break;
+            case 0x67:  // jalr zero/ra, 0(rs1)
+                if (funct3 != 0 || immI != 0 || rs1 == 0 || (rd != 0 && rd != 1)) {
+                    return false;
+                }
+                c = (rd == 0 ? 0x8002 : 0x9002) | (rs1 << 7);  // c.jr/c.jalr
+                break;
+            default:
+                return false;
+        }
+        half = static_cast<uint16_t>(c);
+        return true;
+    }
+    
+    // Instrução de 32 bits equivalente à forma comprimida; 0 se a meia palavra
+    // não for uma instrução comprimida válida (0 também não é válida em 32 bits)
+    static uint32_t expand(uint16_t half) {
+        uint32_t c = half;
+        uint32_t quadrant = c & 3;
+        uint32_t funct3 = (c >> 13) & 7;
+        uint32_t rd = (c >> 7) & 0x1F;        // rd/rs1 completo
+        uint32_t rs2 = (c >> 2) & 0x1F;       // rs2 completo
+        uint32_t rdc = ((c >> 2) & 7) + 8;    // rd'/rs2'
+        uint32_t rs1c = ((c >> 7) & 7) + 8;   // rs1'/rd'
+        int32_t small = static_cast<int32_t>(((c >> 12) & 1) ? 0xFFFFFFE0u : 0u) | static_cast<int32_t>((c >> 2) & 0x1F);
+        
+        auto typeI = [](int32_t imm, uint32_t rs1, uint32_t f3, uint32_t rdField, uint32_t op) {
+            return (static_cast<uint32_t>(imm) << 20) | (rs1 << 15) | (f3 << 12) | (rdField << 7) | op;
+        };
+        auto typeR = [](uint32_t f7, uint32_t rs2Field, uint32_t rs1, uint32_t f3, uint32_t rdField) {
+            return (f7 << 25) | (rs2Field << 20) | (rs1 << 15) | (f3 << 12) | (rdField << 7) | 0x33;
+        };
+        auto typeS = [](int32_t imm, uint32_t rs2Field, uint32_t rs1) {
+            uint32_t u = static_cast<uint32_t>(imm);
+            return ((u >> 5) << 25) | (rs2Field << 20) | (rs1 << 15) | (2u << 12) | ((u & 0x1F) << 7) | 0x23;
+        };
+        auto jumpOffset = [c]() {
+            uint32_t imm = (((c >> 12) & 1) << 11) | (((c >> 11) & 1) << 4) | (((c >> 9) & 3) << 8) |
+                           (((c >> 8) & 1) << 10) | (((c >> 7) & 1) << 6) | (((c >> 6) & 1) << 7) |
+                           (((c >> 3) & 7) << 1) | (((c >> 2) & 1) << 5);
+            return static_cast<int32_t>(imm << 20) >> 20;
+        };
+        auto typeJ = [](int32_t offset, uint32_t rdField) {
+            uint32_t u = static_cast<uint32_t>(offset);
+            return (((u >> 20) & 1) << 31) | (((u >> 1) & 0x3FF) << 21) | (((u >> 11) & 1) << 20) |
+                   (((u >> 12) & 0xFF) << 12) | (rdField << 7) | 0x6F;
+        };
+        
+        if (quadrant == 0) {
+            if (funct3 == 0) {  // c.addi4spn
+                uint32_t imm = (((c >> 11) & 3) << 4) | (((c >> 7) & 0xF) << 6) | (((c >> 6) & 1) << 2) | (((c >> 5) & 1) << 3);
+                return imm == 0 ? 0 : typeI(static_cast<int32_t>(imm), 2, 0, rdc, 0x13);
+            }
+            uint32_t imm = (((c >> 10) & 7) << 3) | (((c >> 6) & 1) << 2) | (((c >> 5) & 1) << 6);
+            if (funct3 == 2) {  // c.lw
+                return typeI(static_cast<int32_t>(imm), rs1c, 2, rdc, 0x03);
+            }
+            if (funct3 == 6) {  // c.sw
+                return typeS(static_cast<int32_t>(imm), rdc, rs1c);
+            }
+            return 0;
+        }
+        
+        if (quadrant == 1) {
+            switch (funct3) {
+                case 0:  // c.nop / c.addi
+                    if ((rd == 0) != (small == 0)) {
+                        return 0;  // dicas não são aceitas
+                    }
+                    return typeI(small, rd, 0, rd, 0x13);
+                case 1:  // c.jal
+                    return typeJ(jumpOffset(), 1);
+                case 2:  // c.li
+                    return rd == 0 ? 0 : typeI(small, 0, 0, rd, 0x13);
+                case 3:
+                    if (rd == 2) {  // c.addi16sp
+                        uint32_t imm = (((c >> 12) & 1) << 9) | (((c >> 6) & 1) << 4) | (((c >> 5) & 1) << 6) |
+                                       (((c >> 3) & 3) << 7) | (((c >> 2) & 1) << 5);
+                        int32_t value = static_cast<int32_t>(imm << 22) >> 22;
+                        return value == 0 ? 0 : typeI(value, 2, 0, 2, 0x13);
+                    }
+                    if (rd == 0 || small == 0) {
+                        return 0;
+                    }
+                    return (static_cast<uint32_t>(small) << 12) | (rd << 7) | 0x37;  // c.lui
+                case 4: {
+                    uint32_t kind = (c >> 10) & 3;
+                    if (kind == 0 || kind == 1) {  // c.srli / c.srai
+                        if (((c >> 12) & 1) != 0 || rs2 == 0) {
+                            return 0;
+                        }
+                        return ((kind == 1 ? 0x20u : 0u) << 25) | (rs2 << 20) | (rs1c << 15) | (5u << 12) | (rs1c << 7) | 0x13;
+                    }
+                    if (kind == 2) {  // c.andi
+                        return typeI(small, rs1c, 7, rs1c, 0x13);
+                    }
+                    if (((c >> 12) & 1) != 0) {
+                        return 0;
+                    }
+                    static const uint32_t f3[4] = {0, 4, 6, 7};
+                    uint32_t op = (c >> 5) & 3;
+                    return typeR(op == 0 ? 0x20 : 0, rdc, rs1c, f3[op], rs1c);  // c.sub/xor/or/and
+                }
+                case 5:  // c.j
+                    return typeJ(jumpOffset(), 0);
+                default: {  // c.beqz / c.bnez
+                    uint32_t imm = (((c >> 12) & 1) << 8) | (((c >> 10) & 3) << 3) | (((c >> 5) & 3) << 6) |
+                                   (((c >> 3) & 3) << 1) | (((c >> 2) & 1) << 5);
+                    uint32_t u = static_cast<uint32_t>(static_cast<int32_t>(imm << 23) >> 23);
+                    return (((u >> 12) & 1) << 31) | (((u >> 5) & 0x3F) << 25) | (rs1c << 15) |
+                           ((funct3 == 6 ? 0u : 1u) << 12) | (((u >> 1) & 0xF) << 8) | (((u >> 11) & 1) << 7) | 0x63;
+                }
+            }
+        }
+        
+        if (quadrant == 2) {
+            switch (funct3) {
+                case 0:  // c.slli
+                    if (rd == 0 || rs2 == 0 || ((c >> 12) & 1) != 0) {
+                        return 0;
+                    }
+                    return (rs2 << 20) | (rd << 15) | (1u << 12) | (rd << 7) | 0x13;
+                case 2: {  // c.lwsp
+                    if (rd == 0) {
+                        return 0;
+                    }
+                    uint32_t imm = (((c >> 12) & 1) << 5) | (((c >> 4) & 7) << 2) | (((c >> 2) & 3) << 6);
+                    return typeI(static_cast<int32_t>(imm), 2, 2, rd, 0x03);
+                }
+                case 4:
+                    if (((c >> 12) & 1) == 0) {
+                        if (rd == 0) {
+                            return 0;
+                        }
+                        return rs2 == 0 ? typeI(0, rd, 0, 0, 0x67)     // c.jr
+                                        : typeR(0, rs2, 0, 0, rd);     // c.mv
+                    }
+                    if (rd == 0) {
+                        return 0;  // c.ebreak não é suportado
+                    }
+                    return rs2 == 0 ? typeI(0, rd, 0, 1, 0x67)         // c.jalr
+                                    : typeR(0, rs2, rd, 0, rd);        // c.add
+                case 6: {  // c.swsp
+                    uint32_t imm = (((c >> 9) & 0xF) << 2) | (((c >> 7) & 3) << 6);
+                    return typeS(static_cast<int32_t>(imm), rs2, 2);
+                }
+                default:
+                    return 0;
+            }
+        }
+        return 0;  // quadrante 3: instrução de 32 bits
+    }
+};
+
+// Modelo de custo do pipeline do núcleo myRV32I, compartilhado pelo
+// simulador (--run) e pelo analisador estático de hazards (--hazards)
+struct PipelineModel {
+    int stages = 5;
+    bool forwarding = true;
+    int loadUsePenalty = 1;  // bolhas entre um load e o uso do resultado (com forwarding)
+    int branchPenalty = 2;   // ciclos perdidos por desvio condicional tomado
+    int jumpPenalty = 2;     // ciclos perdidos por jal/jalr
+    
+    // Ciclos, além do seguinte, até um consumidor poder ser emitido sem bolhas.
+    // Sem forwarding o resultado só é lido do banco de registradores após o WB.
+    int resultLatency(bool isLoad) const {
+        if (!forwarding) {
+            return std::max(0, stages - 3);
+        }
+        return isLoad ? loadUsePenalty : 0;
+    }
+    
+    int fillCycles() const {
+        return stages - 1;
+    }
+    
+    // Interpreta "stages=5,forwarding=0,load-use=1,branch=2,jump=2"
+    bool parse(const std::string& spec) {
+        std::istringstream stream(spec);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            size_t eq = item.find('=');
+            if (eq == std::string::npos) {
+                std::cerr << "Erro: Parâmetro de pipeline inválido: '" << item << "'" << std::endl;
+                return false;
+            }
+            std::string key = item.substr(0, eq);
+            int value = 0;
+            try {
+                value = std::stoi(item.substr(eq + 1));
+            } catch (const std::exception&) {
+                std::cerr << "Erro: Valor inválido para '" << key << "': " << item.substr(eq + 1) << std::endl;
+                return false;
+            }
+            
+            if (key == "stages" && value >= 2) {
+                stages = value;
+            } else if (key == "forwarding") {
+                forwarding = (value != 0);
+            } else if (key == "load-use" && value >= 0) {
+                loadUsePenalty = value;
+            } else if (key == "branch" && value >= 0) {
+                branchPenalty = value;
+            } else if (key == "jump" && value >= 0) {
+                jumpPenalty = value;
+            } else {
+                std::cerr << "Erro: Parâmetro de pipeline inválido: '" << item << "'" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    std::string describe() const {
+        std::ostringstream out;
+        out << stages << " estágios, forwarding " << (forwarding ? "ativado" : "desativado")
+            << ", load-use " << loadUsePenalty << ", desvio tomado " << branchPenalty
+            << ", salto " << jumpPenalty;
+        return out.str();
+    }
+};
+
+// Registradores e efeito de controle de uma instrução, para análise de pipeline
+struct InstructionInfo {
+    uint32_t address;
+    int rd;          // -1 quando não escreve registrador (ou escreve em x0)
+    int rs1;         // -1 quando não lê
+    int rs2;
+    bool isLoad;
+    bool isStore;
+    bool isBranch;   // desvio condicional
+    bool isJump;     // jal/jalr
+    bool hasTarget;  // destino conhecido estaticamente
+    uint32_t target;
+};
+
+// Varredura estrutural do texto de entrada. Encontra de uma só vez as posições
+// de '\n', '#', ':' e ',' no buffer inteiro, 32 ou 16 bytes por iteração
+// (AVX2 ou SSE2, escolhido em tempo de execução) com uma versão escalar para
+// outras arquiteturas. O lexer da primeira passagem consome apenas esse índice:
+// cada linha é delimitada pelos '\n' e dividida em rótulo, comentário e
+// operandos pelas marcas dentro dela, sem nova busca caractere a caractere.
+class StructuralScanner {
+private:
+    static bool isStructural(char c) {
+        return c == '\n' || c == '#' || c == ':' || c == ',';
+    }
+    
+    // Converte os bits de uma máscara em posições. Escreve 8 posições por vez
+    // sem desvio por bit; out precisa de folga de 64 entradas.
+    static uint32_t* flatten(uint32_t* out, uint32_t base, uint64_t mask) {
+        uint32_t count = static_cast<uint32_t>(__builtin_popcountll(mask));
+        uint32_t* next = out + count;
+        while (mask != 0) {
+            for (int k = 0; k < 8; k++) {
+                out[k] = base + static_cast<uint32_t>(__builtin_ctzll(mask | (1ULL << 63)));
+                mask &= mask - 1;
+            }
+            out += 8;
+        }
+        return next;
+    }
+    
+    static uint32_t* scanScalar(const char* data, size_t begin, size_t end, uint32_t* out) {
+        for (size_t i = begin; i < end; i++) {
+            if (isStructural(data[i])) {
+                *out++ = static_cast<uint32_t>(i);
+            }
+        }
+        return out;
+    }
+    
+#if defined(__x86_64__)
+    // SSE2 faz parte da base x86-64
+    static uint32_t* scanSSE2(const char* data, size_t begin, size_t end, uint32_t* out) {
+        const __m128i newline = _mm_set1_epi8('\n');
+        const __m128i hash = _mm_set1_epi8('#');
+        const __m128i colon = _mm_set1_epi8(':');
+        const __m128i comma = _mm_set1_epi8(',');
+        for (size_t i = begin; i < end; i += 64) {
+            uint64_t mask = 0;
+            for (int part = 0; part < 4; part++) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + part * 16));
+                __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, newline), _mm_cmpeq_epi8(v, hash)),
+                                           _mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, comma)));
+                mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(hit))) << (part * 16);
+            }
+            out = flatten(out, static_cast<uint32_t>(i), mask);
+        }
+        return out;
+    }
+    
+    __attribute__((target("avx2")))
+    static uint32_t* scanAVX2(const char* data, size_t begin, size_t end, uint32_t* out) {
+        const __m256i newline = _mm256_set1_epi8('\n');
+        const __m256i hash = _mm256_set1_epi8('#');
+        const __m256i colon = _mm256_set1_epi8(':');
+        const __m256i comma = _mm256_set1_epi8(',');
+        for (size_t i = begin; i < end; i += 64) {
+            __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32));
+            __m256i hitLo = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(lo, newline), _mm256_cmpeq_epi8(lo, hash)),
+                                            _mm256_or_si256(_mm256_cmpeq_epi8(lo, colon), _mm256_cmpeq_epi8(lo, comma)));
+            __m256i hitHi = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(hi, newline), _mm256_cmpeq_epi8(hi, hash)),
+                                            _mm256_or_si256(_mm256_cmpeq_epi8(hi, colon), _mm256_cmpeq_epi8(hi, comma)));
+            uint64_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hitLo)) |
+                            (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(hitHi))) << 32);
+            out = flatten(out, static_cast<uint32_t>(i), mask);
+        }
+        return out;
+    }
+#endif
+
+public:
+    // Maior entrada indexável com posições de 32 bits
+    static const size_t MAX_INPUT_SIZE = 0xFFFFFFFFu;
+    
+    static const char* kernelName() {
+#if defined(__x86_64__)
+        if (__builtin_cpu_supports("avx2")) {
+            return "AVX2";
+        }
+        return "SSE2";
+#endif
+        return "escalar";
+    }
+    
+    // Preenche positions com as posições estruturais de data, em ordem crescente
+    static void scan(const char* data, size_t size, std::vector<uint32_t>& positions) {
+        // Blocos de 64 KiB: o vetor só cresce pelo que foi encontrado, com
+        // folga para o pior caso de um bloco (todo byte estrutural)
+        const size_t BLOCK = 64 * 1024;
+        size_t count = 0;
+        positions.resize(size / 8 + BLOCK + 64);
+        
+#if defined(__x86_64__)
+        bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+        size_t vectorEnd = size - size % 64;
+        for (size_t begin = 0; begin < vectorEnd; begin += BLOCK) {
+            size_t end = std::min(begin + BLOCK, vectorEnd);
+            if (positions.size() < count + BLOCK + 64) {
+                positions.resize(positions.size() * 2);
+            }
+            uint32_t* out = positions.data() + count;
+#if defined(__x86_64__)
+            out = avx2 ? scanAVX2(data, begin, end, out) : scanSSE2(data, begin, end, out);
+#else
+            out = scanScalar(data, begin, end, out);
+#endif
+            count = static_cast<size_t>(out - positions.data());
+        }
+        
+        uint32_t* out = scanScalar(data, vectorEnd, size, positions.data() + count);
+        positions.resize(static_cast<size_t>(out - positions.data()));
+    }
+};
+
+// Tabela de símbolos com endereçamento aberto (sondagem linear).
+// Cada nome é internado uma única vez e recebe um ID denso; as instruções
+// guardam o ID do operando simbólico, resolvido na primeira passagem, e as
+// passagens seguintes consultam o valor por índice, sem hash de strings.
+// Um ID pode existir sem valor (rótulo referenciado e ainda não definido).
+class SymbolTable {
+private:
+    std::vector<std::string> names;   // ID -> nome
+    std::vector<uint64_t> hashes;     // ID -> hash do nome (crescimento sem re-hash)
+    std::vector<int> values;          // ID -> endereço
+    std::vector<uint8_t> defined;     // ID -> possui valor
+    std::vector<uint32_t> slots;      // ID + 1 (0 = vazio); tamanho potência de 2
+    size_t definedCount;
+    
+    static uint64_t hash(const std::string& name) {
+        // FNV-1a 64 bits
+        uint64_t h = 1469598103934665603ULL;
+        for (unsigned char c : name) {
+            h = (h ^ c) * 1099511628211ULL;
+        }
+        return h;
+    }
+    
+    // Posição do nome na tabela ou da vaga em que ele seria inserido
+    size_t probe(const std::string& name, uint64_t h) const {
+        size_t mask = slots.size() - 1;
+        size_t pos = static_cast<size_t>(h) & mask;
+        while (slots[pos] != 0) {
+            uint32_t id = slots[pos] - 1;
+            if (hashes[id] == h && names[id] == name) {
+                break;
+            }
+            pos = (pos + 1) & mask;
+        }
+        return pos;
+    }
+    
+    void rehash(size_t slotCount) {
+        slots.assign(slotCount, 0);
+        size_t mask = slotCount - 1;
+        for (uint32_t id = 0; id < names.size(); id++) {
+            size_t pos = static_cast<size_t>(hashes[id]) & mask;
+            while (slots[pos] != 0) {
+                pos = (pos + 1) & mask;
+            }
+            slots[pos] = id + 1;
+        }
+    }
+
+public:
+    static const uint32_t NONE = 0xFFFFFFFFu;
+    
+    SymbolTable() : slots(16, 0), definedCount(0) {}
+    
+    // Prepara a tabela para n nomes sem crescimentos intermediários
+    void reserve(size_t n) {
+        names.reserve(n);
+        hashes.reserve(n);
+        values.reserve(n);
+        defined.reserve(n);
+        size_t slotCount = slots.size();
+        while (slotCount < n * 2) {
+            slotCount *= 2;
+        }
+        if (slotCount != slots.size()) {
+            rehash(slotCount);
+        }
+    }
+    
+    // Retorna o ID do nome, criando-o (sem valor) se ainda não existir
+    uint32_t intern(const std::string& name) {
+        uint64_t h = hash(name);
+        size_t pos = probe(name, h);
+        if (slots[pos] != 0) {
+            return slots[pos] - 1;
+        }
+        
+        uint32_t id = static_cast<uint32_t>(names.size());
+        names.push_back(name);
+        hashes.push_back(h);
+        values.push_back(0);
+        defined.push_back(0);
+        slots[pos] = id + 1;
+        
+        // Fator de carga máximo de 1/2
+        if (names.size() * 2 > slots.size()) {
+            rehash(slots.size() * 2);
+        }
+        return id;
+    }
+    
+    uint32_t find(const std::string& name) const {
+        size_t pos = probe(name, hash(name));
+        return slots[pos] != 0 ? slots[pos] - 1 : NONE;
+    }
+    
+    void define(uint32_t id, int value) {
+        if (!defined[id]) {
+            defined[id] = 1;
+            definedCount++;
+        }
+        values[id] = value;
+    }
+    
+    void define(const std::string& name, int value) {
+        define(intern(name), value);
+    }
+    
+    bool lookup(uint32_t id, int& value) const {
+        if (id >= names.size() || !defined[id]) {
+            return false;
+        }
+        value = values[id];
+        return true;
+    }
+    
+    bool lookup(const std::string& name, int& value) const {
+        return lookup(find(name), value);
+    }
+    
+    const std::string& name(uint32_t id) const {
+        return names[id];
+    }
+    
+    // Quantidade de símbolos definidos
+    size_t size() const {
+        return definedCount;
+    }
+    
+    // Percorre os símbolos definidos na ordem de criação: f(nome, valor)
+    template <typename Function>
+    void forEach(Function f) const {
+        for (size_t id = 0; id < names.size(); id++) {
+            if (defined[id]) {
+                f(names[id], values[id]);
+            }
+        }
+    }
+};
+
+// Avaliador dos imediatos, sem exceções. Aceita números decimais, 0x (hex),
+// 0b (binário), literais de caractere ('a', '\n') e expressões constantes
+// com rótulos, resolvidas na montagem:
+//   expressão := termo (('+' | '-') termo)*
+//   termo     := ('-' | '+' | '~')* primário
+//   primário  := número | caractere | rótulo | %hi(expressão) | %lo(expressão) | (expressão)
+// usedSymbol() indica se algum rótulo participou; destinos de desvio com
+// rótulo são endereços absolutos, e sem rótulo são offsets relativos ao PC.
+class ImmediateParser {
+private:
+    // Números literais limitados a 32 bits; com poucos termos, int64_t não transborda
+    static const int64_t MAX_LITERAL = 0xFFFFFFFFLL;
+    // Limite de aninhamento: a avaliação é recursiva e não pode esgotar a pilha
+    static const int MAX_DEPTH = 256;
+    
+    const SymbolTable& symbols;
+    const char* pos;
+    const char* end;
+    bool hasSymbol;
+    int depth;
+    std::string error;
+    std::string missing;  // primeiro símbolo sem valor encontrado
+    
+    static bool isSymbolStart(char c) {
+        return std::isalpha(static_cast<unsigned char>(c)) || c == '_' || c == '.' || c == '$';
+    }
+    
+    static bool isSymbolChar(char c) {
+        return isSymbolStart(c) || std::isdigit(static_cast<unsigned char>(c));
+    }
+    
+    // Fim do nome "N@k" (k-ésima definição do rótulo local N) que começa em
+    // begin, ou nullptr se não há um ali
+    static const char* localSymbolEnd(const char* begin, const char* end) {
+        const char* p = begin;
+        while (p < end && std::isdigit(static_cast<unsigned char>(*p))) p++;
+        if (p == begin || p >= end || *p != '@') {
+            return nullptr;
+        }
+        const char* digits = ++p;
+        while (p < end && std::isdigit(static_cast<unsigned char>(*p))) p++;
+        if (p == digits || (p < end && isSymbolChar(*p))) {
+            return nullptr;
+        }
+        return p;
+    }
+    
+    // Consulta o símbolo pos[0, nameEnd) e avança pos até o fim do nome
+    bool parseSymbol(const char* nameEnd, int64_t& value) {
+        std::string name(pos, nameEnd);
+        pos = nameEnd;
+        int address = 0;
+        if (!symbols.lookup(name, address)) {
+            if (missing.empty()) {
+                missing = name;
+            }
+            return fail("Rótulo não encontrado '" + name + "'");
+        }
+        hasSymbol = true;
+        value = address;
+        return true;
+    }
+    
+    bool fail(const std::string& message) {
+        if (error.empty()) {
+            error = message;
+        }
+        return false;
+    }
+    
+    void skipSpaces() {
+        while (pos < end && (*pos == ' ' || *pos == '\t')) {
+            pos++;
+        }
+    }
+    
+    bool parseNumber(int64_t& value) {
+        const char* start = pos;
+        int base = 10;
+        if (end - pos > 2 && pos[0] == '0' && (pos[1] == 'x' || pos[1] == 'X')) {
+            base = 16;
+            pos += 2;
+        } else if (end - pos > 2 && pos[0] == '0' && (pos[1] == 'b' || pos[1] == 'B') &&
+                   (pos[2] == '0' || pos[2] == '1')) {
+            base = 2;
+            pos += 2;
+        }
+        
+        uint64_t number = 0;
+        std::from_chars_result result = std::from_chars(pos, end, number, base);
+        if (result.ec != std::errc() || number > static_cast<uint64_t>(MAX_LITERAL)) {
+            return fail("Número inválido ou maior que 32 bits '" + std::string(start, end) + "'");
+        }
+        pos = result.ptr;
+        if (pos < end && isSymbolChar(*pos)) {
+            if (base == 10 && (*pos == 'b' || *pos == 'f')) {
+                return fail("Rótulo local '" + std::string(start, pos + 1) + "' só pode ser usado sozinho");
+            }
+            return fail("Número inválido '" + std::string(start, end) + "'");
+        }
+        value = static_cast<int64_t>(number);
+        return true;
+    }
+    
+    bool parseCharacter(int64_t& value) {
+        // 'c' ou '\c'
+        const char* start = pos++;
+        if (pos >= end) {
+            return fail("Literal de caractere incompleto");
+        }
+        char c = *pos++;
+        if (c == '\\') {
+            if (pos >= end) {
+                return fail("Literal de caractere incompleto");
+            }
+            switch (*pos++) {
+                case 'n': c = '\n'; break;
+                case 't': c = '\t'; break;
+                case 'r': c = '\r'; break;
+                case '0': c = '\0'; break;
+                case '\\': c = '\\'; break;
+                case '\'': c = '\''; break;
+                case '"': c = '"'; break;
+                default:
+                    return fail("Escape inválido em " + std::string(start, pos));
+            }
+        }
+        if (pos >= end || *pos != '\'') {
+            return fail("Literal de caractere inválido " + std::string(start, std::min(pos + 1, end)));
+        }
+        pos++;
+        value = static_cast<unsigned char>(c);
+        return true;
+    }
+    
+    bool parsePrimary(int64_t& value) {
+        skipSpaces();
+        if (pos >= end) {
+            return fail("Expressão incompleta");
+        }
+        
+        if (std::isdigit(static_cast<unsigned char>(*pos))) {
+            const char* local = localSymbolEnd(pos, end);
+            return local ? parseSymbol(local, value) : parseNumber(value);
+        }
+        if (*pos == '\'') {
+            return parseCharacter(value);
+        }
+        if (*pos == '(') {
+            pos++;
+            if (!parseExpression(value)) {
+                return false;
+            }
+            skipSpaces();
+            if (pos >= end || *pos != ')') {
+                return fail("')' esperado");
+            }
+            pos++;
+            return true;
+        }
+        if (*pos == '%') {
+            // %hi(x): 20 bits altos, compensando o sinal de %lo; %lo(x): 12 bits baixos com sinal
+            const char* start = ++pos;
+            while (pos < end && isSymbolChar(*pos)) {
+                pos++;
+            }
+            std::string modifier(start, pos);
+            if ((modifier != "hi" && modifier != "lo") || pos >= end || *pos != '(') {
+                return fail("Modificador inválido '%" + modifier + "'");
+            }
+            int64_t inner = 0;
+            if (!parsePrimary(inner)) {
+                return false;
+            }
+            int64_t low = ((inner & 0xFFF) ^ 0x800) - 0x800;
+            value = modifier == "lo" ? low : ((inner - low) >> 12) & 0xFFFFF;
+            return true;
+        }
+        if (isSymbolStart(*pos)) {
+            const char* nameEnd = pos;
+            while (nameEnd < end && isSymbolChar(*nameEnd)) {
+                nameEnd++;
+            }
+            return parseSymbol(nameEnd, value);
+        }
+        return fail("Caractere inesperado '" + std::string(1, *pos) + "'");
+    }
+    
+    // Todo aninhamento (operador unário, parênteses, %hi/%lo) passa por aqui
+    bool parseTerm(int64_t& value) {
+        if (depth == MAX_DEPTH) {
+            return fail("Expressão aninhada demais (limite de " + std::to_string(MAX_DEPTH) + " níveis)");
+        }
+        depth++;
+        bool ok;
+        skipSpaces();
+        if (pos < end && (*pos == '-' || *pos == '+' || *pos == '~')) {
+            char op = *pos++;
+            ok = parseTerm(value);
+            if (ok) {
+                value = op == '-' ? -value : (op == '~' ? ~value : value);
+            }
+        } else {
+            ok = parsePrimary(value);
+        }
+        depth--;
+        return ok;
+    }
+    
+    bool parseExpression(int64_t& value) {
+        if (!parseTerm(value)) {
+            return false;
+        }
+        for (;;) {
+            skipSpaces();
+            if (pos >= end || (*pos != '+' && *pos != '-')) {
+                return true;
+            }
+            char op = *pos++;
+            int64_t rhs = 0;
+            if (!parseTerm(rhs)) {
+                return false;
+            }
+            value = op == '+' ? value + rhs : value - rhs;
+        }
+    }
+
+public:
+    explicit ImmediateParser(const SymbolTable& table)
+        : symbols(table), pos(nullptr), end(nullptr), hasSymbol(false), depth(0) {}
+    
+    bool evaluate(const std::string& text, int64_t& value) {
+        pos = text.data();
+        end = pos + text.size();
+        hasSymbol = false;
+        depth = 0;
+        error.clear();
+        missing.clear();
+        
+        if (!parseExpression(value)) {
+            return false;
+        }
+        skipSpaces();
+        if (pos != end) {
+            return fail("Texto inesperado '" + std::string(pos, end) + "' em '" + text + "'");
+        }
+        return true;
+    }
+    
+    bool usedSymbol() const {
+        return hasSymbol;
+    }
+    
+    // Só a sintaxe de text (literais, parênteses, rótulos locais), com todo
+    // rótulo valendo 0; symbol indica se algum participou, e então value não
+    // é o valor final
+    static bool checkSyntax(const std::string& text, int64_t& value, bool& symbol, std::string& message) {
+        SymbolTable names;
+        forEachSymbolName(text, [&](const std::string& name) {
+            names.define(name, 0);
+        });
+        ImmediateParser parser(names);
+        bool ok = parser.evaluate(text, value);
+        symbol = parser.usedSymbol();
+        message = parser.getError();
+        return ok;
+    }
+    
+    const std::string& getError() const {
+        return error;
+    }
+    
+    // Símbolo que faltou na última avaliação com erro ("" se o erro foi outro)
+    const std::string& missingSymbol() const {
+        return missing;
+    }
+    
+    // Nome que pode ser um rótulo sozinho (sem expressão)
+    static bool isSymbolName(const std::string& text) {
+        if (text.empty() || !isSymbolStart(text[0])) {
+            return false;
+        }
+        for (char c : text) {
+            if (!isSymbolChar(c)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    // Visita cada nome com cara de símbolo em um texto, incluindo os "N@k" dos
+    // rótulos locais (registradores e %hi/%lo também aparecem; quem chama
+    // filtra pelos rótulos definidos)
+    template <typename F>
+    static void forEachSymbolName(const std::string& text, F visit) {
+        const char* data = text.data();
+        const char* end = data + text.size();
+        for (size_t i = 0; i < text.size();) {
+            if (!isSymbolChar(text[i])) {
+                i++;
+                continue;
+            }
+            size_t start = i;
+            const char* local = localSymbolEnd(data + start, end);
+            if (local) {
+                i = static_cast<size_t>(local - data);
+                visit(text.substr(start, i - start));
+                continue;
+            }
+            while (i < text.size() && isSymbolChar(text[i])) {
+                i++;
+            }
+            if (isSymbolStart(text[start])) {
+                visit(text.substr(start, i - start));
+            }
+        }
+    }
+};
+
+// Imagem de memória esparsa: trechos contíguos de palavras de 32 bits,
+// indexados pelo endereço inicial. Programas com .org (vetores de reset e de
+// trap, por exemplo) ocupam apenas o que foi montado, não o intervalo inteiro.
+class MemoryImage {
+public:
+    typedef std::map<uint32_t, std::vector<uint32_t>> SegmentMap;
+
+private:
+    SegmentMap segments;  // endereço inicial -> palavras
+    
+    static void appendHexAddress(std::ostream& out, uint64_t address) {
+        out << std::uppercase << std::hex << address << std::dec << std::nouppercase;
+    }
+    
+    // Lê o formato do montador: um byte binário por linha, a partir do endereço 0
+    static bool readBytes(std::istream& file, const std::string& path, MemoryImage& image) {
+        std::string line;
+        uint32_t word = 0;
+        uint32_t address = 0;
+        int byteIndex = 0;
+        int lineNumber = 0;
+        
+        while (std::getline(file, line)) {
+            lineNumber++;
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (line.empty()) {
+                continue;
+            }
+            if (line.size() != 8 || line.find_first_not_of("01") != std::string::npos) {
+                std::cerr << "Erro: Linha " << lineNumber << " de " << path
+                          << " não é um byte binário: '" << line << "'" << std::endl;
+                return false;
+            }
+            
+            word |= static_cast<uint32_t>(std::stoul(line, nullptr, 2)) << (8 * byteIndex);
+            if (++byteIndex == 4) {
+                image.append(address, word);
+                address += 4;
+                word = 0;
+                byteIndex = 0;
+            }
+        }
+        
+        if (byteIndex != 0) {
+            std::cerr << "Erro: " << path << " não contém um número inteiro de palavras de 32 bits" << std::endl;
+            return false;
+        }
+        return true;
+    }
+    
+    // Lê um .mif do Quartus (WIDTH=8 ou 32). Faixas "[a..b] : 0;" são lacunas e
+    // não viram conteúdo; os demais valores são gravados byte a byte.
+    static bool readQuartus(std::istream& file, const std::string& path, MemoryImage& image) {
+        int width = 8;
+        int addressRadix = 16;
+        int dataRadix = 2;
+        bool inContent = false;
+        std::vector<std::pair<uint32_t, uint8_t>> bytes;  // endereço de byte -> valor
+        std::string line;
+        int lineNumber = 0;
+        
+        auto radixOf = [](const std::string& name) {
+            return name == "HEX" ? 16 : name == "BIN" ? 2 : name == "OCT" ? 8 : 10;
+        };
+        auto parseNumber = [](const std::string& text, int radix, uint64_t& value) {
+            std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), value, radix);
+            return result.ec == std::errc() && result.ptr == text.data() + text.size();
+        };
+        
+        while (std::getline(file, line)) {
+            lineNumber++;
+            size_t comment = line.find("--");
+            if (comment != std::string::npos) {
+                line.erase(comment);
+            }
+            std::string text;
+            for (char c : line) {
+                if (!std::isspace(static_cast<unsigned char>(c))) {
+                    text += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+                }
+            }
+            if (text.empty()) {
+                continue;
+            }
+            
+            if (!inContent) {
+                if (text.compare(0, 6, "WIDTH=") == 0) {
+                    width = std::atoi(text.c_str() + 6);
+                } else if (text.compare(0, 14, "ADDRESS_RADIX=") == 0) {
+                    addressRadix = radixOf(text.substr(14, text.size() - 15));
+                } else if (text.compare(0, 11, "DATA_RADIX=") == 0) {
+                    dataRadix = radixOf(text.substr(11, text.size() - 12));
+                } else if (text == "CONTENTBEGIN" || text == "CONTENT") {
+                    inContent = true;
+                }
+                continue;
+            }
+            if (text == "BEGIN") {
+                continue;
+            }
+            if (text.compare(0, 4, "END;") == 0) {
+                break;
+            }
+            
+            // "endereço : valor;" ou "[início..fim] : valor;"
+            size_t colon = text.find(':');
+            if (colon == std::string::npos || text.back() != ';') {
+                std::cerr << "Erro: Linha " << lineNumber << " de " << path << " inválida: '" << line << "'" << std::endl;
+                return false;
+            }
+            std::string where = text.substr(0, colon);
+            std::string valueText = text.substr(colon + 1, text.size() - colon - 2);
+            uint64_t first = 0;
+            uint64_t last = 0;
+            uint64_t value = 0;
+            bool ok = parseNumber(valueText, dataRadix, value);
+            if (where.size() > 2 && where.front() == '[' && where.back() == ']') {
+                size_t dots = where.find("..");
+                ok = ok && dots != std::string::npos &&
+                     parseNumber(where.substr(1, dots - 1), addressRadix, first) &&
+                     parseNumber(where.substr(dots + 2, where.size() - dots - 3), addressRadix, last);
+            } else {
+                ok = ok && parseNumber(where, addressRadix, first);
+                last = first;
+            }
+            uint64_t unit = (width == 32) ? 4 : 1;
+            if (!ok || last < first || (last + 1) * unit > 0x100000000ULL || (width != 8 && width != 32)) {
+                std::cerr << "Erro: Linha " << lineNumber << " de " << path << " inválida: '" << line << "'" << std::endl;
+                return false;
+            }
+            if (value == 0 && last > first) {
+                continue;  // lacuna
+            }
+            for (uint64_t a = first; a <= last; a++) {
+                for (uint64_t b = 0; b < unit; b++) {
+                    bytes.push_back({static_cast<uint32_t>(a * unit + b), static_cast<uint8_t>(value >> (8 * b))});
+                }
+            }
+        }
+        
+        // Agrupa os bytes em palavras alinhadas; bytes ausentes de uma palavra valem 0
+        std::sort(bytes.begin(), bytes.end());
+        for (size_t i = 0; i < bytes.size();) {
+            uint32_t address = bytes[i].first & ~3u;
+            uint32_t word = 0;
+            for (; i < bytes.size() && (bytes[i].first & ~3u) == address; i++) {
+                word |= static_cast<uint32_t>(bytes[i].second) << (8 * (bytes[i].first & 3));
+            }
+            image.append(address, word);
+        }
+        return true;
+    }
+
+public:
+    void clear() {
+        segments.clear();
+    }
+    
+    bool empty() const {
+        return segments.empty();
+    }
+    
+    // Acrescenta uma palavra; endereços consecutivos estendem o último trecho.
+    // Uma instrução de 32 bits após uma comprimida começa no meio de uma palavra.
+    void append(uint32_t address, uint32_t word) {
+        if ((address & 2) != 0) {
+            appendHalfword(address, static_cast<uint16_t>(word));
+            appendHalfword(address + 2, static_cast<uint16_t>(word >> 16));
+            return;
+        }
+        if (!segments.empty()) {
+            auto last = std::prev(segments.end());
+            if (static_cast<uint64_t>(last->first) + last->second.size() * 4 == address) {
+                last->second.push_back(word);
+                return;
+            }
+        }
+        segments[address].push_back(word);
+    }
+    
+    // Acrescenta meia palavra (instrução comprimida). A metade superior completa
+    // a última palavra; a inferior abre uma palavra nova, com a metade de cima
+    // em zero até ser preenchida (0x0000 não é uma instrução válida).
+    void appendHalfword(uint32_t address, uint16_t half) {
+        if ((address & 2) == 0) {
+            append(address, half);
+            return;
+        }
+        if (!segments.empty()) {
+            auto last = std::prev(segments.end());
+            if (static_cast<uint64_t>(last->first) + last->second.size() * 4 == static_cast<uint64_t>(address) + 2) {
+                last->second.back() |= static_cast<uint32_t>(half) << 16;
+                return;
+            }
+        }
+        append(address - 2, static_cast<uint32_t>(half) << 16);
+    }
+    
+    // Sobrescreve size bytes (2 ou 4) já acrescentados a partir de address;
+    // usado para corrigir referências adiante quando o rótulo é definido
+    void patch(uint32_t address, uint32_t value, uint32_t size) {
+        for (uint32_t offset = 0; offset < size; offset += 2) {
+            uint32_t at = address + offset;
+            auto it = std::prev(segments.upper_bound(at));
+            uint32_t& word = it->second[(at - it->first) / 4];
+            uint32_t shift = (at & 2) * 8;
+            word = (word & ~(0xFFFFu << shift)) | (((value >> (offset * 8)) & 0xFFFF) << shift);
+        }
+    }
+    
+    const SegmentMap& getSegments() const {
+        return segments;
+    }
+    
+    size_t wordCount() const {
+        size_t count = 0;
+        for (const auto& segment : segments) {
+            count += segment.second.size();
+        }
+        return count;
+    }
+    
+    uint32_t startAddress() const {
+        return segments.empty() ? 0 : segments.begin()->first;
+    }
+    
+    // Palavra no endereço dado, se algum trecho o contém
+    bool wordAt(uint32_t address, uint32_t& word) const {
+        auto it = segments.upper_bound(address);
+        if (it == segments.begin()) {
+            return false;
+        }
+        --it;
+        uint64_t offset = (address - it->first) / 4;
+        if ((address & 3) != 0 || offset >= it->second.size()) {
+            return false;
+        }
+        word = it->second[offset];
+        return true;
+    }
+    
+    // Primeiro endereço após o último trecho
+    uint64_t endAddress() const {
+        if (segments.empty()) {
+            return 0;
+        }
+        auto last = std::prev(segments.end());
+        return static_cast<uint64_t>(last->first) + last->second.size() * 4;
+    }
+    
+    // Um único trecho a partir do endereço 0 (representável no formato de bytes)
+    bool isDense() const {
+        return segments.empty() || (segments.size() == 1 && segments.begin()->first == 0);
+    }
+    
+    // Grava a imagem. Imagens densas usam o formato original do montador (um
+    // byte binário por linha); imagens esparsas, ou quartus = true, usam o .mif
+    // do Quartus, com cada lacuna escrita como uma única faixa "[a..b] : 0;".
+    bool write(const std::string& path, bool quartus) const {
+        std::ofstream file(path);
+        if (!file.is_open()) {
+            std::cerr << "Erro: Não foi possível abrir o arquivo de saída: " << path << std::endl;
+            return false;
+        }
+        
+        if (!quartus && isDense()) {
+            std::string out;
+            out.reserve(wordCount() * 36);
+            for (const auto& segment : segments) {
+                for (uint32_t word : segment.second) {
+                    for (int byte = 0; byte < 4; byte++) {
+                        out += std::bitset<8>((word >> (byte * 8)) & 0xFF).to_string();
+                        out += '\n';
+                    }
+                }
+            }
+            file << out;
+            return static_cast<bool>(file);
+        }
+        
+        file << "-- myRV32I: imagem de memória em bytes, little-endian" << '\n';
+        file << "WIDTH=8;" << '\n';
+        file << "DEPTH=" << std::max<uint64_t>(endAddress(), 4) << ";" << '\n';
+        file << "ADDRESS_RADIX=HEX;" << '\n';
+        file << "DATA_RADIX=BIN;" << '\n' << '\n';
+        file << "CONTENT BEGIN" << '\n';
+        
+        uint64_t next = 0;
+        for (const auto& segment : segments) {
+            if (segment.first > next) {
+                file << "\t[";
+                appendHexAddress(file, next);
+                file << "..";
+                appendHexAddress(file, segment.first - 1);
+                file << "] : 00000000;" << '\n';
+            }
+            uint64_t address = segment.first;
+            for (uint32_t word : segment.second) {
+                for (int byte = 0; byte < 4; byte++, address++) {
+                    file << '\t';
+                    appendHexAddress(file, address);
+                    file << " : " << std::bitset<8>((word >> (byte * 8)) & 0xFF).to_string() << ";\n";
+                }
+            }
+            next = address;
+        }
+        file << "END;" << '\n';
+        return static_cast<bool>(file);
+    }
+    
+    // Lê um .mif em qualquer dos dois formatos de write
+    static bool read(const std::string& path, MemoryImage& image) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            std::cerr << "Erro: Não foi possível abrir o arquivo de entrada: " << path << std::endl;
+            return false;
+        }
+        
+        // O formato do Quartus tem cabeçalho (WIDTH=, DEPTH=, comentários "--")
+        std::string first;
+        std::streampos start = file.tellg();
+        while (std::getline(file, first) && first.find_first_not_of(" \t\r") == std::string::npos) {
+        }
+        file.clear();
+        file.seekg(start);
+        
+        bool quartus = first.find_first_not_of("01\r") != std::string::npos;
+        image.clear();
+        return quartus ? readQuartus(file, path, image) : readBytes(file, path, image);
+    }
+};
+
+// Fila limitada de um produtor para um consumidor, sem travas: head só é
+// escrito por quem consome e tail só por quem produz. Fila cheia (ou vazia)
+// faz a thread ceder o processador até o outro lado andar, o que limita a
+// memória em trânsito entre os estágios do pipeline de montagem.
+template <typename T>
+class BoundedQueue {
+private:
+    std::vector<T> slots;
+    alignas(64) std::atomic<size_t> head;  // próximo item a consumir
+    alignas(64) std::atomic<size_t> tail;  // próxima posição livre
+
+public:
+    explicit BoundedQueue(size_t capacity) : slots(capacity), head(0), tail(0) {}
+    
+    void push(T value) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        while (position - head.load(std::memory_order_acquire) == slots.size()) {
+            std::this_thread::yield();
+        }
+        slots[position % slots.size()] = std::move(value);
+        tail.store(position + 1, std::memory_order_release);
+    }
+    
+    T pop() {
+        size_t position = head.load(std::memory_order_relaxed);
+        while (tail.load(std::memory_order_acquire) == position) {
+            std::this_thread::yield();
+        }
+        T value = std::move(slots[position % slots.size()]);
+        head.store(position + 1, std::memory_order_release);
+        return value;
+    }
+};
+
+class Assembler {
+public:
+    // Diagnóstico do modo --check; linha e coluna começam em 1
+    struct Diagnostic {
+        int line;
+        int column;
+        std::string message;
+    };
+    
+    // Resultado da análise de um trecho do fonte que não depende do resto do
+    // arquivo. Linhas são relativas ao início do trecho.
+    struct CheckChunk {
+        enum EventKind { LOCAL_DEFINITION, LOCAL_REFERENCE, REFERENCE, ORIGIN };
+        struct Event {
+            EventKind kind;
+            int line;
+            int column;
+            std::string text;  // rótulo local, imediato com rótulos ou índice em origins
+        };
+        
+        std::string text;                      // conteúdo, para confirmar o hash
+        int lines;
+        std::vector<Diagnostic> diagnostics;   // opcode, operandos, registradores, imediatos, li/la
+        std::vector<std::string> labels;       // rótulos definidos (exceto os locais)
+        std::vector<Event> events;             // na ordem do fonte
+        std::vector<Instruction> origins;      // diretivas .org, validadas no contexto do arquivo
+    };
+    
+    // Trechos já analisados pelo --check, indexados pelo hash do conteúdo.
+    // Compartilhado entre as threads do servidor: um fonte reenviado a cada
+    // tecla só reanalisa os trechos que mudaram.
+    class CheckCache {
+    private:
+        struct Entry {
+            std::shared_ptr<const CheckChunk> chunk;
+            uint64_t lastUse;
+        };
+        std::mutex mutex;
+        std::unordered_map<uint64_t, Entry> entries;
+        uint64_t generation = 0;
+    
+    public:
+        // Começa uma verificação; devolve a geração usada para marcar os trechos
+        uint64_t begin() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return ++generation;
+        }
+        
+        std::shared_ptr<const CheckChunk> find(uint64_t hash, const char* data, size_t size, uint64_t use) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto entry = entries.find(hash);
+            if (entry == entries.end() || entry->second.chunk->text.size() != size ||
+                std::memcmp(entry->second.chunk->text.data(), data, size) != 0) {
+                return nullptr;
+            }
+            entry->second.lastUse = use;
+            return entry->second.chunk;
+        }
+        
+        void insert(uint64_t hash, std::shared_ptr<const CheckChunk> chunk, uint64_t use) {
+            std::lock_guard<std::mutex> lock(mutex);
+            entries[hash] = {std::move(chunk), use};
+        }
+        
+        // Descarta trechos não usados nas últimas verificações quando o cache
+        // passa bastante do tamanho de um fonte
+        void trim(size_t chunksInUse, uint64_t use) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (entries.size() <= 2 * chunksInUse + 1024) {
+                return;
+            }
+            for (auto entry = entries.begin(); entry != entries.end();) {
+                if (entry->second.lastUse + 8 < use) {
+                    entry = entries.erase(entry);
+                } else {
+                    ++entry;
+                }
+            }
+        }
+    };
+    
+private:
+    friend class EncoderFuzzer;  // Teste diferencial acessa os codificadores diretamente
+    
+    std::string inputFile;
+    std::string outputFile;
+    std::vector<Instruction> instructions;
+    SymbolTable symbolTable;
+    std::unordered_map<std::string, std::unordered_map<std::string, int>> registerTable;
+    std::unordered_map<std::string, InstructionDescriptor> opcodeTable;
+    MemoryImage image;  // Palavras codificadas, por endereço
+    bool debugMode;  
+    bool quietMode;  // Suprime as mensagens de progresso (erros continuam em stderr)
+    bool quartusOutput;  // Grava sempre no formato do Quartus, mesmo com imagem densa
+    bool scheduleEnabled;
+    PipelineModel scheduleModel;
+    bool compressionEnabled;  // Usa a forma de 16 bits sempre que possível
+    bool cfgOptimization;  // Encadeamento de saltos e remoção de código inalcançável
+    bool profileLayout;    // Reordena os blocos básicos pelas contagens de profileCounts
+    std::unordered_map<int, uint64_t> profileCounts;  // linha do fonte -> execuções
+    std::ostream* errors;  // Diagnósticos (std::cerr por padrão)
+    mutable std::string unresolvedSymbol;  // Primeiro símbolo sem valor pedido por evaluateImmediate
+    
+    // Erro de validação ainda sem coluna: operand é o índice do operando (-1: o opcode)
+    struct PendingDiagnostic {
+        int line;
+        int operand;
+        std::string message;
+    };
+    std::vector<PendingDiagnostic>* diagnosticSink;  // não nulo durante o --check
+    std::shared_ptr<CheckCache> checkCache;
+    
+    // Diretiva .org: a instrução de índice index começa em address
+    struct Origin {
+        size_t index;
+        uint32_t address;
+        int line;
+    };
+    
+    // Função para inicializar a tabela de registradores
+    void initRegisterTable() {
+        registerTable["x"] = {};
+        for (int i = 0; i < 32; i++) {
+            registerTable["x"][std::to_string(i)] = i;
+        }
+        registerTable["zero"] = {{"", 0}};
+        registerTable["ra"] = {{"", 1}};
+        registerTable["sp"] = {{"", 2}};
+        registerTable["gp"] = {{"", 3}};
+        registerTable["tp"] = {{"", 4}};
+        
+        registerTable["t"] = {};
+        for (int i = 0; i <= 2; i++) {
+            registerTable["t"][std::to_string(i)] = i + 5;
+        }
+        for (int i = 3; i <= 6; i++) {
+            registerTable["t"][std::to_string(i)] = i + 25;
+        }
+        
+        registerTable["s"] = {};
+        registerTable["s"]["0"] = 8;
+        registerTable["s"]["1"] = 9;
+        for (int i = 2; i <= 11; i++) {
+            registerTable["s"][std::to_string(i)] = i + 16;
+        }
+        
+        registerTable["a"] = {};
+        for (int i = 0; i <= 7; i++) {
+            registerTable["a"][std::to_string(i)] = i + 10;
+        }
+        
+        registerTable["fp"] = {{"", 8}}; 
+    }
+    
+    // Avalia um imediato: número, literal de caractere ou expressão com rótulos.
+    // Um operando que é só um rótulo usa o ID resolvido na primeira passagem;
+    // os demais passam pelo ImmediateParser. Não imprime nada: em caso de
+    // falha, error recebe a mensagem.
+    bool evaluateImmediate(const Instruction& instr, const std::string& operand, int64_t& value,
+                           bool& hasSymbol, std::string& error) const {
+        if (instr.symbol >= 0) {
+            int address = 0;
+            if (symbolTable.lookup(static_cast<uint32_t>(instr.symbol), address)) {
+                value = address;
+                hasSymbol = true;
+                return true;
+            }
+            if (isLocalLabelReference(operand)) {
+                if (unresolvedSymbol.empty()) {
+                    unresolvedSymbol = symbolTable.name(static_cast<uint32_t>(instr.symbol));
+                }
+                error = "Rótulo não encontrado '" + operand + "'";
+                return false;
+            }
+        }
+        
+        ImmediateParser parser(symbolTable);
+        if (!parser.evaluate(operand, value)) {
+            if (unresolvedSymbol.empty()) {
+                unresolvedSymbol = parser.missingSymbol();
+            }
+            error = parser.getError();
+            return false;
+        }
+        hasSymbol = parser.usedSymbol();
+        return true;
+    }
+    
+    // Mensagem de erro de codificação, com a linha do fonte quando conhecida
+    void reportError(const Instruction& instr, const std::string& message) const {
+        if (diagnosticSink) {
+            diagnosticSink->push_back({instr.line, -1, message});
+        } else if (instr.line > 0) {
+            *errors << "Erro na linha " << instr.line << ": " << message << std::endl;
+        } else {
+            *errors << "Erro: " << message << std::endl;
+        }
+    }
+    
+    // Avalia o imediato de um campo e confere se cabe nele: [min, max] e múltiplo
+    // de align. Com pcRelative, um destino com rótulo vira offset a partir do
+    // endereço da instrução atual.
+    bool immediateField(const Instruction& instr, const std::string& operand, int64_t min, int64_t max,
+                        int64_t align, bool pcRelative, int& imm) const {
+        int64_t value = 0;
+        bool hasSymbol = false;
+        std::string error;
+        if (!evaluateImmediate(instr, operand, value, hasSymbol, error)) {
+            reportError(instr, error);
+            return false;
+        }
+        if (pcRelative && hasSymbol) {
+            // Aritmética de endereços módulo 2^32 (rótulos acima de 2 GiB são negativos na tabela)
+            value = static_cast<int32_t>(static_cast<uint32_t>(value - instr.address));
+        }
+        if (value < min || value > max || value % align != 0) {
+            reportError(instr, rangeMessage(instr.opcode, value, min, max, align));
+            return false;
+        }
+        imm = static_cast<int>(value);
+        return true;
+    }
+    
+    static std::string rangeMessage(const std::string& opcode, int64_t value, int64_t min, int64_t max, int64_t align) {
+        std::ostringstream message;
+        message << "Imediato fora do intervalo para " << opcode << ": " << value
+                << " (esperado " << min << ".." << max;
+        if (align > 1) {
+            message << ", múltiplo de " << align;
+        }
+        message << ")";
+        return message.str();
+    }
+    
+    // Operando imediato de instr e a faixa do seu campo, as mesmas dos
+    // codificadores. Retorna o índice do operando (-1 se não há imediato).
+    int immediateOperand(const Instruction& instr, std::string& text, int64_t& min, int64_t& max,
+                         int64_t& align) const {
+        auto entry = opcodeTable.find(instr.opcode);
+        if (entry == opcodeTable.end()) {
+            return -1;
+        }
+        const std::vector<std::string>& operands = instr.operands;
+        std::string base;
+        min = -2048;
+        max = 2047;
+        align = 1;
+        switch (entry->second.type) {
+            case I_TYPE:
+                if (instr.opcode == "jalr" || instr.opcode.find("l") == 0) {
+                    if (operands.size() >= 2 && splitMemoryOperand(operands[1], text, base)) {
+                        return 1;  // offset(rs1)
+                    }
+                } else if (instr.opcode == "slli" || instr.opcode == "srli" || instr.opcode == "srai") {
+                    min = 0;
+                    max = 31;
+                }
+                break;
+            case S_TYPE:
+                return operands.size() >= 2 && splitMemoryOperand(operands[1], text, base) ? 1 : -1;
+            case B_TYPE:
+                min = -4096;
+                max = 4094;
+                align = 2;
+                break;
+            case U_TYPE:
+                min = -524288;
+                max = 0xFFFFF;
+                if (operands.size() < 2) {
+                    return -1;
+                }
+                text = operands[1];
+                return 1;
+            case J_TYPE:
+                min = -1048576;
+                max = 1048574;
+                align = 2;
+                if (operands.size() < 2) {
+                    return -1;
+                }
+                text = operands[1];
+                return 1;
+            default:
+                return -1;
+        }
+        if (operands.size() < 3) {
+            return -1;
+        }
+        text = operands[2];
+        return 2;
+    }
+    
+    // Divide "offset(rs1)" em offset e registrador base. O registrador é o último
+    // grupo entre parênteses, para que o offset possa ser "%lo(x)"; sem offset vale 0.
+    static bool splitMemoryOperand(const std::string& op, std::string& offset, std::string& base) {
+        size_t closeParen = op.find_last_not_of(" \t");
+        if (closeParen == std::string::npos || op[closeParen] != ')') {
+            return false;
+        }
+        size_t openParen = op.rfind('(', closeParen);
+        if (openParen == std::string::npos) {
+            return false;
+        }
+        offset = trimmed(op.data(), op.data() + openParen);
+        if (offset.empty()) {
+            offset = "0";
+        }
+        base = trimmed(op.data() + openParen + 1, op.data() + closeParen);
+        return true;
+    }
+    
+    // Rótulo local numérico: "1b" (definição anterior mais próxima) ou "1f" (seguinte)
+    static bool isLocalLabelReference(const std::string& operand) {
+        return operand.size() >= 2 && (operand.back() == 'b' || operand.back() == 'f') &&
+               operand.find_first_not_of("0123456789") == operand.size() - 1;
+    }
+    
+    static bool isLocalLabel(const std::string& label) {
+        return !label.empty() && label.find_first_not_of("0123456789") == std::string::npos;
+    }
+    
+    // Índice do operando que pode ser um símbolo (-1 se o formato não tem)
+    int symbolOperandIndex(const Instruction& instr) const {
+        auto entry = opcodeTable.find(instr.opcode);
+        if (entry == opcodeTable.end()) {
+            return -1;
+        }
+        size_t index = 0;
+        switch (entry->second.type) {
+            case B_TYPE:
+                index = 2;
+                break;
+            case U_TYPE:
+            case J_TYPE:
+                index = 1;
+                break;
+            case I_TYPE:
+                if (entry->second.opcode == "0000011") {
+                    return -1;  // loads usam offset(rs1)
+                }
+                index = 2;
+                break;
+            default:
+                return -1;
+        }
+        return index < instr.operands.size() ? static_cast<int>(index) : -1;
+    }
+    
+    // Função para inicializar a tabela de opcodes
+    void initOpcodeTable() {
+        for (size_t i = 0; i < INSTRUCTION_DESCRIPTOR_COUNT; i++) {
+            opcodeTable[INSTRUCTION_DESCRIPTORS[i].mnemonic] = INSTRUCTION_DESCRIPTORS[i];
+        }
+    }
+    
+    // Função para converter uma string de registrador para seu número
+    int getRegisterNumber(const std::string& reg) {
+        int number = lookupRegister(reg);
+        if (number == -1) {
+            *errors << "Erro: Registrador desconhecido: " << reg << std::endl;
+        }
+        return number;
+    }
+    
+    // Mesma conversão de getRegisterNumber, sem mensagem de erro (-1 se inválido)
+    int lookupRegister(const std::string& reg) {
+        if (reg == "zero") return 0;
+        
+        // Verificar se é x0-x31 (sem std::regex: esta função é chamada por operando)
+        if (reg.size() > 1 && reg.size() <= 10 && reg[0] == 'x' &&
+            reg.find_first_not_of("0123456789", 1) == std::string::npos) {
+            int num = std::stoi(reg.substr(1));
+            if (num >= 0 && num < 32) {
+                return num;
+            }
+        }
+        
+        // Verificar outros formatos de registradores (t0, a0, s0, etc.)
+        char prefix = reg[0];
+        if (reg.size() > 1 && registerTable.find(std::string(1, prefix)) != registerTable.end()) {
+            std::string suffix = reg.substr(1);
+            if (registerTable[std::string(1, prefix)].find(suffix) != registerTable[std::string(1, prefix)].end()) {
+                return registerTable[std::string(1, prefix)][suffix];
+            }
+        }
+        
+        if (registerTable.find(reg) != registerTable.end() && registerTable[reg].find("") != registerTable[reg].end()) {
+            return registerTable[reg][""];
+        }
+        
+        return -1;
+    }
+    
+    // Bytes restantes no fluxo, ou -1 se ele não permite posicionamento
+    static int64_t remainingSize(std::istream& source) {
+        std::streampos start = source.tellg();
+        if (start == std::streampos(-1) || !source.seekg(0, std::ios::end)) {
+            source.clear();
+            return -1;
+        }
+        std::streamoff size = source.tellg() - start;
+        source.seekg(start);
+        return static_cast<int64_t>(size);
+    }
+    
+    // Lê todo o conteúdo do fluxo, de uma vez quando o tamanho é conhecido
+    static void readAll(std::istream& source, std::string& text) {
+        int64_t size = remainingSize(source);
+        if (size >= 0) {
+            text.resize(static_cast<size_t>(size));
+            source.read(&text[0], size);
+            text.resize(static_cast<size_t>(source.gcount()));
+            return;
+        }
+        std::ostringstream buffer;
+        buffer << source.rdbuf();
+        text = buffer.str();
+    }
+    
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+    
+    // Texto de [begin, end) sem espaços nas pontas
+    static std::string trimmed(const char* begin, const char* end) {
+        while (begin < end && isSpace(*begin)) begin++;
+        while (end > begin && isSpace(end[-1])) end--;
+        return std::string(begin, end);
+    }
+    
+    // Posição da aspa final do literal de caractere ('c' ou '\c') que começa em
+    // data[quote], ou quote se não há um literal completo antes de end
+    static size_t characterLiteralEnd(const char* data, size_t quote, size_t end) {
+        size_t pos = quote + 1;
+        if (pos < end && data[pos] == '\\') {
+            pos++;
+        }
+        pos++;
+        return pos < end && data[pos] == '\'' ? pos : quote;
+    }
+    
+    // Primeira ocorrência de c em line[0, length) fora de literais de caractere
+    static const char* findUnquoted(const char* line, size_t length, char c) {
+        for (size_t i = 0; i < length; i++) {
+            if (line[i] == c) {
+                return line + i;
+            }
+            if (line[i] == '\'') {
+                i = characterLiteralEnd(line, i, length);
+            }
+        }
+        return nullptr;
+    }
+    
+    // Função para analisar a linha data[begin, end) e lidar com pseudoinstruções.
+    // marks são as posições estruturais ('#', ':', ',') dentro da linha, vindas
+    // da varredura do StructuralScanner. Numa linha com aspas, as marcas dentro
+    // de um literal de caractere (':', ',', '#') são descartadas antes.
+    Instruction parseLine(const char* data, size_t begin, size_t end, const uint32_t* marks, size_t markCount) {
+        std::vector<uint32_t> unquoted;
+        if (markCount > 0 && std::memchr(data + begin, '\'', end - begin) != nullptr) {
+            size_t quote = begin;
+            size_t close = begin;
+            for (size_t j = 0; j < markCount; j++) {
+                // Avança até o literal que termina depois da marca, parando no comentário
+                while (close < marks[j] && quote < end && data[quote] != '#') {
+                    if (data[quote] == '\'') {
+                        close = characterLiteralEnd(data, quote, end);
+                        if (close > marks[j]) {
+                            break;
+                        }
+                        quote = close;
+                    }
+                    quote++;
+                    close = quote;
+                }
+                if (!(quote < marks[j] && marks[j] < close)) {
+                    unquoted.push_back(marks[j]);
+                }
+            }
+            marks = unquoted.data();
+            markCount = unquoted.size();
+        }
+        
+        // Remover comentários
+        for (size_t j = 0; j < markCount; j++) {
+            if (data[marks[j]] == '#') {
+                end = marks[j];
+                markCount = j;
+                break;
+            }
+        }
+        
+        std::string label = "";
+        std::string opcode = "";
+        std::vector<std::string> operands;
+        
+        // Verificar se há rótulo
+        size_t pos = begin;
+        for (size_t j = 0; j < markCount; j++) {
+            if (data[marks[j]] == ':') {
+                label = trimmed(data + begin, data + marks[j]);
+                pos = marks[j] + 1;
+                break;
+            }
+        }
+        
+        // Se após remover o rótulo a linha estiver vazia retornar
+        while (pos < end && isSpace(data[pos])) pos++;
+        while (end > pos && isSpace(data[end - 1])) end--;
+        if (pos == end) {
+            return Instruction(label, "", {});
+        }
+        
+        // O opcode vai até o primeiro espaço; o resto da linha são os operandos
+        size_t opcodeEnd = pos;
+        while (opcodeEnd < end && !isSpace(data[opcodeEnd])) opcodeEnd++;
+        opcode.assign(data + pos, opcodeEnd - pos);
+        
+        // "c.<instrução>" exige a forma comprimida. Os nomes próprios do RVC
+        // viram a instrução base (c.beqz -> beq, c.lwsp -> lw, ...)
+        std::string compressedName;
+        if (opcode.size() > 2 && opcode.compare(0, 2, "c.") == 0) {
+            compressedName = opcode.substr(2);
+            static const std::unordered_map<std::string, std::string> RVC_NAMES = {
+                {"beqz", "beq"}, {"bnez", "bne"}, {"lwsp", "lw"}, {"swsp", "sw"},
+                {"addi16sp", "addi"}, {"addi4spn", "addi"}
+            };
+            auto base = RVC_NAMES.find(compressedName);
+            opcode = (base != RVC_NAMES.end()) ? base->second : compressedName;
+        }
+        
+        // Vírgulas que separam os operandos
+        std::vector<size_t> commas;
+        for (size_t j = 0; j < markCount; j++) {
+            if (marks[j] >= opcodeEnd && marks[j] < end && data[marks[j]] == ',') {
+                commas.push_back(marks[j]);
+            }
+        }
+        
+        // Para instruções de load/store, o formato pode ser "lw rd, offset(rs1)"
+        if (opcode == "lb" || opcode == "lh" || opcode == "lw" || opcode == "lbu" || opcode == "lhu" ||
+            opcode == "sb" || opcode == "sh" || opcode == "sw") {
+            
+            // Dividir no primeiro operando
+            if (!commas.empty()) {
+                operands.push_back(trimmed(data + opcodeEnd, data + commas[0]));
+                operands.push_back(trimmed(data + commas[0] + 1, data + end));
+            }
+        } else if (opcodeEnd < end) {
+            // Dividir operandos por vírgula
+            size_t operandBegin = opcodeEnd;
+            for (size_t k = 0; k <= commas.size(); k++) {
+                size_t operandEnd = k < commas.size() ? commas[k] : end;
+                std::string operand = trimmed(data + operandBegin, data + operandEnd);
+                if (!operand.empty()) {
+                    operands.push_back(operand);
+                }
+                operandBegin = operandEnd + 1;
+            }
+        }
+        
+        // Operandos na sintaxe do RVC, em que rd também é o primeiro operando fonte
+        if (!compressedName.empty()) {
+            if ((compressedName == "beqz" || compressedName == "bnez") && operands.size() == 2) {
+                operands.insert(operands.begin() + 1, "zero");
+            } else if (compressedName == "addi16sp" && operands.size() == 1) {
+                operands.insert(operands.begin(), {"sp", "sp"});
+            } else if (compressedName == "addi4spn" && operands.size() == 2) {
+                operands.insert(operands.begin() + 1, "sp");
+            } else if (compressedName == "jal" && operands.size() == 1) {
+                operands.insert(operands.begin(), "ra");
+            } else if (compressedName == "jalr" && operands.size() == 1) {
+                operands = {"ra", operands[0], "0"};
+            } else if (operands.size() == 2 &&
+                       (opcode == "addi" || opcode == "slli" || opcode == "srli" || opcode == "srai" ||
+                        opcode == "andi" || opcode == "add" || opcode == "sub" || opcode == "xor" ||
+                        opcode == "or" || opcode == "and")) {
+                operands.insert(operands.begin() + 1, operands[0]);
+            }
+        }
+        
+        // Lidar com pseudoinstruções
+        if (opcode == "j") {
+            // "j label" é uma pseudoinstrução para "jal zero, label"
+            if (operands.size() == 1) {
+                opcode = "jal";
+                operands.insert(operands.begin(), "zero");
+            }
+        } else if (opcode == "jr") {
+            // "jr rs" é uma pseudoinstrução para "jalr zero, rs, 0"
+            if (operands.size() == 1) {
+                opcode = "jalr";
+                operands.insert(operands.begin(), "zero");
+                operands.push_back("0");
+            }
+        } else if (opcode == "mv") {
+            // "mv rd, rs" é uma pseudoinstrução para "addi rd, rs, 0"
+            if (operands.size() == 2) {
+                opcode = "addi";
+                operands.push_back("0");
+            }
+        } else if (opcode == "li" && !compressedName.empty()) {
+            // "c.li rd, imm" é sempre um único "addi rd, zero, imm"; o "li" comum
+            // é expandido por expandConstantLoad, com o tamanho que o valor pedir
+            if (operands.size() == 2) {
+                opcode = "addi";
+                operands.insert(operands.begin() + 1, "zero");
+            }
+        } else if (opcode == "nop") {
+            // "nop" é uma pseudoinstrução para "addi zero, zero, 0"
+            opcode = "addi";
+            operands = {"zero", "zero", "0"};
+        } else if (opcode == "bgt") {
+            // "bgt rs1, rs2, label" é uma pseudoinstrução para "blt rs2, rs1, label"
+            if (operands.size() == 3) {
+                opcode = "blt";
+                std::swap(operands[0], operands[1]);
+            }
+        } else if (opcode == "ble") {
+            // "ble rs1, rs2, label" é uma pseudoinstrução para "bge rs2, rs1, label"
+            if (operands.size() == 3) {
+                opcode = "bge";
+                std::swap(operands[0], operands[1]);
+            }
+        }
+        
+        Instruction instr(label, opcode, operands);
+        if (!compressedName.empty()) {
+            instr.size = 2;
+            instr.forceCompressed = true;
+        }
+        return instr;
+    }
+    
+    // Função para codificar instruções tipo R
+    std::string encodeRType(const Instruction& instr) {
+        // Formato: funct7[31:25] rs2[24:20] rs1[19:15] funct3[14:12] rd[11:7] opcode[6:0]
+        std::string binary = "";
+        const InstructionDescriptor& desc = opcodeTable[instr.opcode];
+        
+        // Obter números dos registradores
+        int rd = getRegisterNumber(instr.operands[0]);
+        int rs1 = getRegisterNumber(instr.operands[1]);
+        int rs2 = getRegisterNumber(instr.operands[2]);
+        
+        // Construir a instrução binária usando strings
+        binary += desc.funct7;
+        binary += std::bitset<5>(rs2).to_string();
+        binary += std::bitset<5>(rs1).to_string();
+        binary += desc.funct3;
+        binary += std::bitset<5>(rd).to_string();
+        binary += desc.opcode;
+        
+        return binary;
+    }
+    
+    // Função para codificar instruções tipo I
+    std::string encodeIType(const Instruction& instr) {
+        // Formato: imm[11:0] rs1[19:15] funct3[14:12] rd[11:7] opcode[6:0]
+        std::string binary = "";
+        const InstructionDescriptor& desc = opcodeTable[instr.opcode];
+        
+        // Obter números dos registradores
+        int rd = getRegisterNumber(instr.operands[0]);
+        int rs1 = 0;
+        int imm = 0;
+        
+        // Analisar o formato específico da instrução
+        if (instr.opcode == "jalr" || 
+            instr.opcode == "lb" || instr.opcode == "lh" || instr.opcode == "lw" || 
+            instr.opcode == "lbu" || instr.opcode == "lhu") {
+            
+            // Formato: lw rd, imm(rs1)
+            std::string offset, base;
+            if (splitMemoryOperand(instr.operands[1], offset, base)) {
+                rs1 = getRegisterNumber(base);
+                if (!immediateField(instr, offset, -2048, 2047, 1, false, imm)) {
+                    return "";
+                }
+            } else if (instr.opcode == "jalr") {
+                // Formatos alternativos para jalr
+                if (instr.operands.size() == 2) {
+                    // jalr rd, rs1
+                    rs1 = getRegisterNumber(instr.operands[1]);
+                    imm = 0;
+                } else if (instr.operands.size() == 3) {
+                    // jalr rd, rs1, imm
+                    rs1 = getRegisterNumber(instr.operands[1]);
+                    if (!immediateField(instr, instr.operands[2], -2048, 2047, 1, false, imm)) {
+                        return "";
+                    }
+                } else {
+                    *errors << "Erro: Formato inválido para instrução jalr" << std::endl;
+                    return "";
+                }
+            } else {
+                *errors << "Erro: Formato inválido para instrução de load: " << instr.operands[1] << std::endl;
+                return "";
+            }
+        } else {
+            // Formato normal: addi rd, rs1, imm (shifts: shamt de 5 bits)
+            rs1 = getRegisterNumber(instr.operands[1]);
+            bool isShift = (instr.opcode == "slli" || instr.opcode == "srli" || instr.opcode == "srai");
+            if (!immediateField(instr, instr.operands[2], isShift ? 0 : -2048, isShift ? 31 : 2047, 1, false, imm)) {
+                return "";
+            }
+        }
+        
+        // Construir a instrução binária
+        std::string immBinary;
+        if (instr.opcode == "slli" || instr.opcode == "srli" || instr.opcode == "srai") {
+            // Para instruções de shift, os bits do imediato são diferentes
+            immBinary = desc.funct7 + std::bitset<5>(imm).to_string();
+        } else {
+            // Imediato de 12 bits com sinal
+            std::string immStr = std::bitset<12>(imm & 0xFFF).to_string();
+            immBinary = immStr;
+        }
+        
+        binary += immBinary;
+        binary += std::bitset<5>(rs1).to_string();
+        binary += desc.funct3;
+        binary += std::bitset<5>(rd).to_string();
+        binary += desc.opcode;
+        
+        return binary;
+    }
+    
+    // Função para codificar instruções tipo S
+    std::string encodeSType(const Instruction& instr) {
+        // Formato: imm[11:5] rs2[24:20] rs1[19:15] funct3[14:12] imm[4:0] opcode[6:0]
+        std::string binary = "";
+        const InstructionDescriptor& desc = opcodeTable[instr.opcode];
+        
+        // Obter números dos registradores
+        int rs2 = getRegisterNumber(instr.operands[0]);
+        
+        // Formato: sw rs2, imm(rs1)
+        std::string offset, base;
+        int rs1 = 0;
+        int imm = 0;
+        if (splitMemoryOperand(instr.operands[1], offset, base)) {
+            rs1 = getRegisterNumber(base);
+            if (!immediateField(instr, offset, -2048, 2047, 1, false, imm)) {
+                return "";
+            }
+        } else {
+            *errors << "Erro: Formato inválido para instrução de store: " << instr.operands[1] << std::endl;
+            return "";
+        }
+        
+        // Construir a instrução binária
+        std::string immBinary = std::bitset<12>(imm & 0xFFF).to_string();
+        
+        binary += immBinary.substr(0, 7);  // imm[11:5]
+        binary += std::bitset<5>(rs2).to_string();
+        binary += std::bitset<5>(rs1).to_string();
+        binary += desc.funct3;
+        binary += immBinary.substr(7, 5);  // imm[4:0]
+        binary += desc.opcode;
+        
+        return binary;
+    }
+    
+    // Função para codificar instruções tipo B
+    std::string encodeBType(const Instruction& instr) {
+        // Formato: imm[12|10:5] rs2[24:20] rs1[19:15] funct3[14:12] imm[4:1|11] opcode[6:0]
+        std::string binary = "";
+        const InstructionDescriptor& desc = opcodeTable[instr.opcode];
+        
+        // Obter números dos registradores
+        int rs1 = getRegisterNumber(instr.operands[0]);
+        int rs2 = getRegisterNumber(instr.operands[1]);
+        
+        // Obter o imediato: rótulo (offset relativo ao PC da instrução atual) ou
+        // offset numérico. Para branch, o offset deve ser múltiplo de 2
+        // (o bit 0 não é armazenado na codificação)
+        int imm = 0;
+        if (!immediateField(instr, instr.operands[2], -4096, 4094, 2, true, imm)) {
+            return "";
+        }
+        
+        // Construir a instrução binária como string
+        // imm tem 13 bits com sinal (bit 0 é sempre 0)
+        std::string immBinary = std::bitset<13>(imm & 0x1FFF).to_string(); // 13 bits
+        
+        // Reorganizar os bits do imediato conforme o formato B
+        binary += immBinary[0];  // imm[12]
+        binary += immBinary.substr(2, 6);  // imm[10:5]
+        binary += std::bitset<5>(rs2).to_string();
+        binary += std::bitset<5>(rs1).to_string();
+        binary += desc.funct3;
+        binary += immBinary.substr(8, 4);  // imm[4:1]
+        binary += immBinary[1];  // imm[11]
+        binary += desc.opcode;
+        
+        return binary;
+    }
+    
+    // Função para codificar instruções tipo U
+    std::string encodeUType(const Instruction& instr) {
+        // Formato: imm[31:12] rd[11:7] opcode[6:0]
+        std::string binary = "";
+        
+        // Obter número do registrador
+        int rd = getRegisterNumber(instr.operands[0]);
+        
+        // Obter o imediato
+        // 20 bits, sem sinal (0..0xFFFFF) ou com sinal
+        int imm = 0;
+        if (!immediateField(instr, instr.operands[1], -524288, 0xFFFFF, 1, false, imm)) {
+            return "";
+        }
+        
+        // Construir a instrução binária
+        std::string immStr = std::bitset<20>(imm & 0xFFFFF).to_string();
+        binary += immStr;
+        binary += std::bitset<5>(rd).to_string();
+        binary += opcodeTable[instr.opcode].opcode;
+        
+        return binary;
+    }
+    
+    // Função para codificar instruções tipo J
+    std::string encodeJType(const Instruction& instr) {
+        // Formato: imm[20|10:1|11|19:12] rd[11:7] opcode[6:0]
+        std::string binary = "";
+        
+        // Obter número do registrador
+        int rd = getRegisterNumber(instr.operands[0]);
+        
+        // Obter o imediato: rótulo (offset relativo ao PC) ou offset numérico,
+        // múltiplo de 2 (o bit 0 não é armazenado na codificação)
+        int imm = 0;
+        if (!immediateField(instr, instr.operands[1], -1048576, 1048574, 2, true, imm)) {
+            return "";
+        }
+        
+        // Construir a instrução binária
+        // Para JAL, imm tem 21 bits 
+        std::string immBinary = std::bitset<21>(imm & 0x1FFFFF).to_string(); // 21 bits
+        
+        // Reorganizar os bits do imediato conforme o formato J
+        binary += immBinary[0];  // imm[20]
+        binary += immBinary.substr(10, 10);  // imm[10:1]
+        binary += immBinary[9];  // imm[11]
+        binary += immBinary.substr(1, 8);  // imm[19:12]
+        binary += std::bitset<5>(rd).to_string();
+        binary += opcodeTable[instr.opcode].opcode;
+        
+        return binary;
+    }
+    
+    // Função para codificar uma instrução para binário
+    std::string encodeToBinary(const Instruction& instr) {
+        if (instr.opcode.empty()) {
+            return "";
+        }
+        
+        // Verificar se o opcode existe na tabela
+        if (opcodeTable.find(instr.opcode) == opcodeTable.end()) {
+            *errors << "Erro: Opcode desconhecido: " << instr.opcode << std::endl;
+            return "";
+        }
+        
+        // Verificar se há operandos suficientes
+        size_t minOperands = 0;
+        InstructionType type = opcodeTable[instr.opcode].type;
+        
+        switch (type) {
+            case R_TYPE:
+                minOperands = 3;  // rd, rs1, rs2
+                break;
+            case I_TYPE:
+                // rd, rs1, imm ou rd, offset(rs1) para jalr e loads
+                minOperands = (instr.opcode == "jalr" || instr.opcode.find("l") == 0) ? 2 : 3;
+                break;
+            case S_TYPE:
+                minOperands = 2;  // rs2, offset(rs1)
+                break;
+            case B_TYPE:
+                minOperands = 3;  // rs1, rs2, offset
+                break;
+            case U_TYPE:
+                minOperands = 2;  // rd, imm
+                break;
+            case J_TYPE:
+                minOperands = 2;  // rd, offset
+                break;
+            default:
+                break;
+        }
+        
+        if (instr.operands.size() < minOperands) {
+            *errors << "Erro: Número insuficiente de operandos para " << instr.opcode 
+                      << ". Esperado: " << minOperands << ", Encontrado: " << instr.operands.size() << std::endl;
+            return "";
+        }
+        
+        // Codificar de acordo com o tipo da instrução
+        std::string binary;
+        switch (type) {
+            case R_TYPE:
+                binary = encodeRType(instr);
+                break;
+            case I_TYPE:
+                binary = encodeIType(instr);
+                break;
+            case S_TYPE:
+                binary = encodeSType(instr);
+                break;
+            case B_TYPE:
+                binary = encodeBType(instr);
+                break;
+            case U_TYPE:
+                binary = encodeUType(instr);
+                break;
+            case J_TYPE:
+                binary = encodeJType(instr);
+                break;
+            default:
+                *errors << "Erro: Tipo de instrução desconhecido para " << instr.opcode << std::endl;
+                return "";
+        }
+        
+        // Verificar se a codificação foi bem-sucedida
+        if (binary.empty()) {
+            *errors << "Erro: Falha ao codificar a instrução: " << instr.opcode << std::endl;
+            return "";
+        }
+        
+        // Verificar se o comprimento do binário é 32 bits
+        if (binary.length() != 32) {
+            *errors << "Erro: Instrução codificada não tem 32 bits: " << binary.length() 
+                      << " bits para " << instr.opcode << std::endl;
+            return "";
+        }
+        
+        return binary;
+    }
+    
+    // Função para converter binário de 32 bits para formato little-endian binário (4 linhas de 8 bits)
+    std::vector<std::string> binaryToLittleEndianBinary(const std::string& binary) {
+        std::vector<std::string> result;
+        
+        if (binary.empty() || binary.length() != 32) {
+            return result;
+        }
+        
+        // Dividir em 4 bytes (8 bits cada) em formato little-endian
+        // Byte 0 (LSB): bits 7-0
+        result.push_back(binary.substr(24, 8));
+        // Byte 1: bits 15-8  
+        result.push_back(binary.substr(16, 8));
+        // Byte 2: bits 23-16
+        result.push_back(binary.substr(8, 8));
+        // Byte 3 (MSB): bits 31-24
+        result.push_back(binary.substr(0, 8));
+        
+        return result;
+    }
+    
+    // Preenche registradores lidos/escritos e destino de desvio da instrução.
+    // Retorna false (sem mensagens) se opcode, operandos ou registradores forem
+    // inválidos; destinos por rótulo só são resolvidos se o símbolo já existir.
+    bool describeInstruction(const Instruction& instr, uint32_t address, InstructionInfo& info) {
+        info = {address, -1, -1, -1, false, false, false, false, false, 0};
+        
+        auto entry = opcodeTable.find(instr.opcode);
+        if (entry == opcodeTable.end()) {
+            return false;
+        }
+        const InstructionDescriptor& desc = entry->second;
+        
+        size_t minOperands = 2;
+        if (desc.type == R_TYPE || desc.type == B_TYPE ||
+            (desc.type == I_TYPE && instr.opcode != "jalr" && desc.opcode != "0000011")) {
+            minOperands = 3;
+        }
+        if (instr.operands.size() < minOperands) {
+            return false;
+        }
+        
+        // Registrador base de um operando no formato offset(rs1)
+        auto baseRegister = [this](const std::string& op) {
+            std::string offset, base;
+            if (!splitMemoryOperand(op, offset, base)) {
+                return lookupRegister(op);
+            }
+            return lookupRegister(base);
+        };
+        
+        // Destino de branch/jal: expressão com rótulo (endereço) ou offset numérico relativo ao PC
+        auto resolveTarget = [&](const std::string& op) {
+            int64_t value = 0;
+            bool hasSymbol = false;
+            std::string error;
+            info.hasTarget = evaluateImmediate(instr, op, value, hasSymbol, error);
+            info.target = static_cast<uint32_t>(hasSymbol ? value : address + value);
+        };
+        
+        switch (desc.type) {
+            case R_TYPE:
+                info.rd = lookupRegister(instr.operands[0]);
+                info.rs1 = lookupRegister(instr.operands[1]);
+                info.rs2 = lookupRegister(instr.operands[2]);
+                if (info.rs2 == -1) return false;
+                break;
+            case I_TYPE:
+                info.rd = lookupRegister(instr.operands[0]);
+                info.rs1 = baseRegister(instr.operands[1]);
+                info.isLoad = (desc.opcode == "0000011");
+                info.isJump = (instr.opcode == "jalr");
+                break;
+            case S_TYPE:
+                info.rs2 = lookupRegister(instr.operands[0]);
+                info.rs1 = baseRegister(instr.operands[1]);
+                info.isStore = true;
+                if (info.rs2 == -1) return false;
+                break;
+            case B_TYPE:
+                info.rs1 = lookupRegister(instr.operands[0]);
+                info.rs2 = lookupRegister(instr.operands[1]);
+                info.isBranch = true;
+                if (info.rs2 == -1) return false;
+                resolveTarget(instr.operands[2]);
+                break;
+            case U_TYPE:
+                info.rd = lookupRegister(instr.operands[0]);
+                info.rs1 = 0;
+                break;
+            case J_TYPE:
+                info.rd = lookupRegister(instr.operands[0]);
+                info.rs1 = 0;
+                info.isJump = true;
+                resolveTarget(instr.operands[1]);
+                break;
+            default:
+                return false;
+        }
+        
+        // Formatos S e B não escrevem registrador
+        if (desc.type != S_TYPE && desc.type != B_TYPE && info.rd == -1) {
+            return false;
+        }
+        if (info.rs1 == -1) {
+            return false;
+        }
+        
+        // x0 nunca cria dependência
+        if (info.rd == 0) info.rd = -1;
+        if (info.rs1 == 0) info.rs1 = -1;
+        if (info.rs2 == 0) info.rs2 = -1;
+        return true;
+    }
+    
+    // Ciclos de emissão em ordem de uma sequência (mesmo modelo do HazardAnalyzer)
+    uint64_t issueCycles(const std::vector<const InstructionInfo*>& sequence) const {
+        uint64_t cycle = 0;
+        uint64_t ready[32] = {0};
+        for (const InstructionInfo* in : sequence) {
+            if (in->rs1 > 0) cycle = std::max(cycle, ready[in->rs1]);
+            if (in->rs2 > 0) cycle = std::max(cycle, ready[in->rs2]);
+            if (in->rd > 0) {
+                ready[in->rd] = cycle + 1 + scheduleModel.resultLatency(in->isLoad);
+            }
+            cycle++;
+        }
+        return cycle;
+    }
+    
+    // Escalonamento de lista de uma região [first, end) de instruções móveis.
+    // Se hasTail, a instrução em end (desvio do mesmo bloco) fica fixa no fim,
+    // mas suas dependências entram na prioridade. Retorna as bolhas economizadas.
+    uint64_t scheduleRegion(size_t first, size_t end, bool hasTail, const std::vector<InstructionInfo>& info) {
+        size_t n = end - first + (hasTail ? 1 : 0);
+        std::vector<const InstructionInfo*> node(n);
+        for (size_t k = 0; k < n; k++) {
+            node[k] = &info[first + k];
+        }
+        
+        // Dependências: RAW com a latência do produtor; WAR, WAW e ordem de memória
+        // (store com qualquer acesso; loads podem trocar de lugar entre si) com latência 0
+        std::vector<std::vector<std::pair<size_t, uint64_t>>> preds(n);
+        std::vector<std::vector<std::pair<size_t, uint64_t>>> succs(n);
+        for (size_t j = 0; j < n; j++) {
+            for (size_t i = 0; i < j; i++) {
+                const InstructionInfo& a = *node[i];
+                const InstructionInfo& b = *node[j];
+                bool raw = a.rd > 0 && (b.rs1 == a.rd || b.rs2 == a.rd);
+                bool war = b.rd > 0 && (a.rs1 == b.rd || a.rs2 == b.rd);
+                bool waw = a.rd > 0 && a.rd == b.rd;
+                bool memory = (a.isStore && (b.isLoad || b.isStore)) || (a.isLoad && b.isStore);
+                bool tail = hasTail && j == n - 1;
+                if (raw || war || waw || memory || tail) {
+                    uint64_t latency = raw ? 1 + scheduleModel.resultLatency(a.isLoad) : 0;
+                    preds[j].push_back({i, latency});
+                    succs[i].push_back({j, latency});
+                }
+            }
+        }
+        
+        // Prioridade: maior caminho de latência até o fim da região
+        std::vector<uint64_t> height(n, 0);
+        for (size_t k = n; k-- > 0;) {
+            for (const auto& s : succs[k]) {
+                height[k] = std::max(height[k], s.second + height[s.first]);
+            }
+        }
+        
+        std::vector<size_t> order;
+        std::vector<uint64_t> issuedAt(n, 0);
+        std::vector<size_t> pendingPreds(n);
+        std::vector<bool> done(n, false);
+        for (size_t k = 0; k < n; k++) {
+            pendingPreds[k] = preds[k].size();
+        }
+        
+        uint64_t cycle = 0;
+        while (order.size() < n) {
+            size_t best = n;
+            uint64_t bestEarliest = 0;
+            for (size_t k = 0; k < n; k++) {
+                if (done[k] || pendingPreds[k] != 0) {
+                    continue;
+                }
+                uint64_t earliest = cycle;
+                for (const auto& p : preds[k]) {
+                    earliest = std::max(earliest, issuedAt[p.first] + p.second);
+                }
+                // Primeiro quem pode sair sem bolha; depois maior altura; depois ordem original
+                bool better = best == n ||
+                    (earliest <= cycle && bestEarliest > cycle) ||
+                    ((earliest <= cycle) == (bestEarliest <= cycle) &&
+                     (earliest <= cycle ? height[k] > height[best]
+                                        : (earliest < bestEarliest ||
+                                           (earliest == bestEarliest && height[k] > height[best]))));
+                if (better) {
+                    best = k;
+                    bestEarliest = earliest;
+                }
+            }
+            
+            cycle = std::max(cycle, bestEarliest);
+            issuedAt[best] = cycle++;
+            done[best] = true;
+            order.push_back(best);
+            for (const auto& s : succs[best]) {
+                pendingPreds[s.first]--;
+            }
+        }
+        
+        const std::vector<const InstructionInfo*>& original = node;
+        std::vector<const InstructionInfo*> scheduled;
+        for (size_t k : order) {
+            scheduled.push_back(node[k]);
+        }
+        uint64_t before = issueCycles(original);
+        uint64_t after = issueCycles(scheduled);
+        if (after >= before) {
+            return 0;
+        }
+        
+        // Aplicar a nova ordem (a cauda continua na mesma posição; os endereços
+        // pertencem às posições, não às instruções)
+        size_t movable = end - first;
+        uint32_t base = instructions[first].address;
+        std::vector<Instruction> reordered;
+        reordered.reserve(movable);
+        for (size_t k = 0; k < movable; k++) {
+            reordered.push_back(std::move(instructions[first + order[k]]));
+        }
+        for (size_t k = 0; k < movable; k++) {
+            instructions[first + k] = std::move(reordered[k]);
+            instructions[first + k].address = base + static_cast<uint32_t>(k * 4);
+        }
+        return before - after;
+    }
+    
+    // Filtro rápido: só estas instruções têm formas comprimidas
+    static bool isCompressionCandidate(const Instruction& instr) {
+        static const char* const CANDIDATES[] = {
+            "addi", "slli", "srli", "srai", "andi", "add", "sub", "xor", "or", "and",
+            "lui", "lw", "sw", "beq", "bne", "jal", "jalr"
+        };
+        for (const char* name : CANDIDATES) {
+            if (instr.opcode == name) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    // Codifica a instrução no endereço atual e procura a forma comprimida,
+    // sem emitir diagnósticos (os erros aparecem na segunda passagem)
+    bool compressInstruction(Instruction& instr, uint16_t& half) {
+        std::ostream* saved = errors;
+        std::ostringstream discarded;
+        errors = &discarded;
+        std::string binary = encodeToBinary(instr);
+        errors = saved;
+        return !binary.empty() && CompressedCodec::compress(static_cast<uint32_t>(std::stoul(binary, nullptr, 2)), half);
+    }
+    
+    // Índice da instrução no endereço dado (instructions.size() se não houver).
+    // Os endereços crescem com o índice, já que .org só avança.
+    size_t instructionAt(uint32_t address) const {
+        auto it = std::lower_bound(instructions.begin(), instructions.end(), address,
+                                   [](const Instruction& instr, uint32_t value) { return instr.address < value; });
+        if (it == instructions.end() || it->address != address) {
+            return instructions.size();
+        }
+        return static_cast<size_t>(it - instructions.begin());
+    }
+    
+    // Reordena instruções independentes dentro de cada bloco básico para esconder
+    // a latência de loads. Rótulos, desvios, saltos, auipc (depende do PC) e
+    // instruções inválidas delimitam as regiões, então nada cruza essas fronteiras;
+    // o mesmo vale para as lacunas criadas por .org. labels: rótulo -> índice da
+    // instrução seguinte.
+    void scheduleInstructions(const std::vector<std::pair<uint32_t, size_t>>& labels) {
+        // Regiões longas são divididas em janelas para manter o custo linear
+        const size_t WINDOW = 128;
+        size_t count = instructions.size();
+        std::vector<InstructionInfo> info(count);
+        std::vector<bool> movable(count, false);
+        std::vector<bool> blockStart(count + 1, false);
+        
+        for (const auto& label : labels) {
+            blockStart[label.second] = true;
+        }
+        for (size_t i = 0; i < count; i++) {
+            bool valid = describeInstruction(instructions[i], instructions[i].address, info[i]);
+            bool control = valid && (info[i].isBranch || info[i].isJump);
+            // O par lui/addi de um li/la com rótulo fica junto: o layout ainda escolhe a forma
+            movable[i] = valid && !control && instructions[i].opcode != "auipc" && instructions[i].constant.empty();
+            if (control && info[i].hasTarget) {
+                blockStart[instructionAt(info[i].target)] = true;  // destino por offset numérico
+            }
+            if (i > 0 && instructions[i].address != instructions[i - 1].address + 4) {
+                blockStart[i] = true;  // início de um trecho .org
+            }
+        }
+        
+        uint64_t saved = 0;
+        size_t regions = 0;
+        for (size_t first = 0; first < count;) {
+            if (!movable[first]) {
+                first++;
+                continue;
+            }
+            size_t end = first + 1;
+            while (end < count && movable[end] && !blockStart[end] && end - first < WINDOW) {
+                end++;
+            }
+            bool hasTail = end < count && !blockStart[end] && !movable[end] &&
+                           (info[end].isBranch || info[end].isJump);
+            
+            if (end - first > 1) {
+                // O rótulo da linha fica no início do bloco, não com a instrução movida
+                std::string label = instructions[first].label;
+                instructions[first].label.clear();
+                uint64_t gain = scheduleRegion(first, end, hasTail, info);
+                instructions[first].label = label;
+                if (gain > 0) {
+                    saved += gain;
+                    regions++;
+                }
+            }
+            first = end;
+        }
+        
+        if (!quietMode) {
+            std::cout << "Escalonamento: " << regions << " região(ões) reordenada(s), "
+                      << saved << " bolha(s) estimada(s) eliminada(s)" << std::endl;
+        }
+    }
+    
+    // Estimativa da distância em bytes entre as instruções from e to antes do
+    // layout: cada instrução conta 4 bytes e um trecho .org começa no seu
+    // endereço. Não é uma cota: li/la longos, desvios relaxados (8 ou 12 bytes)
+    // e a reordenação por perfil ainda podem afastar as duas. Um encadeamento
+    // que deixa de caber é relaxado no layout; o código continua certo, só
+    // perde parte do ganho.
+    static uint64_t distanceBound(const std::vector<Origin>& origins, size_t from, size_t to) {
+        auto segment = [&](size_t index, uint64_t& start, size_t& first) {
+            start = 0;
+            first = 0;
+            for (const Origin& origin : origins) {
+                if (origin.index > index) {
+                    break;
+                }
+                start = origin.address;
+                first = origin.index;
+            }
+        };
+        uint64_t fromStart = 0, toStart = 0;
+        size_t fromFirst = 0, toFirst = 0;
+        segment(from, fromStart, fromFirst);
+        segment(to, toStart, toFirst);
+        if (fromFirst == toFirst) {
+            return 4 * static_cast<uint64_t>(from > to ? from - to : to - from);
+        }
+        uint64_t fromEnd = fromStart + 4 * static_cast<uint64_t>(from - fromFirst);
+        uint64_t toEnd = toStart + 4 * static_cast<uint64_t>(to - toFirst);
+        uint64_t forward = toEnd > fromStart ? toEnd - fromStart : fromStart - toEnd;
+        uint64_t backward = fromEnd > toStart ? fromEnd - toStart : toStart - fromEnd;
+        return std::max(forward, backward);
+    }
+    
+    // Endereços provisórios (4 bytes por instrução) depois de uma passagem que
+    // muda a lista de instruções, para o escalonamento
+    void assignProvisionalAddresses(const std::vector<Origin>& origins) {
+        uint64_t location = 0;
+        size_t nextOrigin = 0;
+        for (size_t i = 0; i < instructions.size(); i++) {
+            while (nextOrigin < origins.size() && origins[nextOrigin].index == i) {
+                location = origins[nextOrigin++].address;
+            }
+            instructions[i].address = static_cast<uint32_t>(location);
+            location += instructions[i].size == 0 ? 0 : 4;
+        }
+    }
+    
+    // Otimização do grafo de fluxo de controle, antes do escalonamento e do
+    // layout. Desvios e saltos cujo destino é um "jal zero" passam a apontar
+    // direto para o destino final da cadeia; blocos básicos que não são
+    // alcançáveis a partir da entrada, dos trechos .org e dos rótulos usados
+    // como endereço (la, %hi/%lo, jalr) são removidos, assim como um "jal zero"
+    // para a instrução seguinte. Só roda quando todo destino de desvio é um
+    // rótulo definido: offsets numéricos e auipc dependem das distâncias que a
+    // remoção muda. labels e origins são reindexados.
+    void optimizeControlFlow(std::vector<std::pair<uint32_t, size_t>>& labels, std::vector<Origin>& origins) {
+        const size_t NO_TARGET = static_cast<size_t>(-1);
+        size_t count = instructions.size();
+        std::unordered_map<uint32_t, size_t> labelIndex;
+        for (const auto& label : labels) {
+            labelIndex[label.first] = label.second;
+        }
+        
+        std::vector<size_t> target(count, NO_TARGET);
+        std::vector<InstructionType> type(count, UNKNOWN);
+        std::vector<bool> root(count + 1, false);
+        std::string skipped;
+        for (size_t i = 0; i < count && skipped.empty(); i++) {
+            const Instruction& instr = instructions[i];
+            auto entry = opcodeTable.find(instr.opcode);
+            if (entry == opcodeTable.end()) {
+                continue;  // a validação reporta
+            }
+            type[i] = entry->second.type;
+            if (instr.opcode == "auipc") {
+                skipped = "auipc na linha " + std::to_string(instr.line);
+                break;
+            }
+            if (type[i] != B_TYPE && type[i] != J_TYPE) {
+                // Rótulo usado como valor: o endereço pode chegar a um jalr
+                if (instr.symbol >= 0) {
+                    auto label = labelIndex.find(static_cast<uint32_t>(instr.symbol));
+                    if (label != labelIndex.end()) {
+                        root[label->second] = true;
+                    }
+                }
+                for (const std::string& operand : instr.operands) {
+                    ImmediateParser::forEachSymbolName(operand, [&](const std::string& name) {
+                        uint32_t id = symbolTable.find(name);
+                        auto label = id == SymbolTable::NONE ? labelIndex.end() : labelIndex.find(id);
+                        if (label != labelIndex.end()) {
+                            root[label->second] = true;
+                        }
+                    });
+                }
+                continue;
+            }
+            int index = symbolOperandIndex(instr);
+            if (index < 0) {
+                continue;
+            }
+            const std::string& operand = instr.operands[index];
+            auto label = instr.symbol >= 0 ? labelIndex.find(static_cast<uint32_t>(instr.symbol)) : labelIndex.end();
+            if (label == labelIndex.end() ||
+                (!ImmediateParser::isSymbolName(operand) && !isLocalLabelReference(operand))) {
+                skipped = "destino '" + operand + "' na linha " + std::to_string(instr.line);
+                break;
+            }
+            target[i] = label->second;
+        }
+        if (!skipped.empty()) {
+            if (!quietMode) {
+                std::cout << "Otimização do CFG ignorada: " << skipped << std::endl;
+            }
+            return;
+        }
+        
+        auto destination = [&](size_t i) {
+            return instructions[i].operands.empty() ? -1 : lookupRegister(instructions[i].operands[0]);
+        };
+        auto isJump = [&](size_t i) {
+            return i < count && type[i] == J_TYPE && target[i] != NO_TARGET && destination(i) == 0;
+        };
+        
+        // Encadeamento de saltos: segue "jal zero" até onde a estimativa de
+        // distância ainda cabe no campo de offset da instrução (±4 KiB nos
+        // desvios, ±1 MiB no jal)
+        size_t threaded = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (target[i] == NO_TARGET) {
+                continue;
+            }
+            uint64_t range = type[i] == B_TYPE ? 4094 : 1048574;
+            size_t best = target[i];
+            int bestSymbol = instructions[i].symbol;
+            size_t current = target[i];
+            for (size_t hops = 0; isJump(current) && current != i && hops < count; hops++) {
+                int symbol = instructions[current].symbol;
+                current = target[current];
+                if (distanceBound(origins, i, current) <= range) {
+                    best = current;
+                    bestSymbol = symbol;
+                }
+            }
+            if (best != target[i]) {
+                Instruction& instr = instructions[i];
+                instr.symbol = bestSymbol;
+                instr.operands[symbolOperandIndex(instr)] = symbolTable.name(static_cast<uint32_t>(bestSymbol));
+                target[i] = best;
+                threaded++;
+            }
+        }
+        
+        // Blocos básicos: começam na entrada, em rótulos, em destinos, após
+        // desvios e saltos, e em cada .org
+        std::vector<bool> leader(count + 1, false);
+        leader[0] = leader[count] = true;
+        root[0] = true;
+        for (const auto& label : labels) {
+            leader[label.second] = true;
+        }
+        for (const Origin& origin : origins) {
+            leader[origin.index] = true;
+            root[origin.index] = true;  // vetores de reset e de trap
+        }
+        for (size_t i = 0; i < count; i++) {
+            if (target[i] != NO_TARGET) {
+                leader[target[i]] = true;
+            }
+            if (type[i] == B_TYPE || type[i] == J_TYPE || instructions[i].opcode == "jalr") {
+                leader[i + 1] = true;
+            }
+        }
+        
+        // Alcance: desvios seguem para o destino e para a próxima instrução;
+        // jal e jalr com rd != zero são chamadas e também voltam para a seguinte
+        std::vector<bool> reached(count, false);
+        std::vector<size_t> pending;
+        for (size_t i = 0; i < count; i++) {
+            if (root[i]) {
+                pending.push_back(i);
+            }
+        }
+        while (!pending.empty()) {
+            size_t first = pending.back();
+            pending.pop_back();
+            if (first >= count || reached[first]) {
+                continue;
+            }
+            size_t last = first;
+            reached[first] = true;
+            while (!leader[last + 1]) {
+                reached[++last] = true;
+            }
+            bool fallsThrough = true;
+            if (target[last] != NO_TARGET) {
+                pending.push_back(target[last]);
+                fallsThrough = type[last] == B_TYPE || destination(last) != 0;
+            } else if (instructions[last].opcode == "jalr") {
+                fallsThrough = destination(last) != 0;
+            }
+            if (fallsThrough) {
+                pending.push_back(last + 1);
+            }
+        }
+        
+        // "jal zero" para a próxima instrução mantida, no mesmo trecho .org
+        std::vector<bool> keep(reached);
+        std::vector<bool> originAt(count + 1, false);
+        for (const Origin& origin : origins) {
+            originAt[origin.index] = true;
+        }
+        for (size_t i = 0; i < count; i++) {
+            if (!keep[i] || !isJump(i) || target[i] <= i) {
+                continue;
+            }
+            size_t next = i + 1;
+            while (next < target[i] && !keep[next] && !originAt[next]) {
+                next++;
+            }
+            if (next == target[i] && !originAt[next]) {
+                keep[i] = false;
+            }
+        }
+        
+        // Compacta e reindexa; rótulos de instruções removidas marcam a seguinte mantida
+        std::vector<size_t> newIndex(count + 1, 0);
+        std::vector<Instruction> kept;
+        kept.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            newIndex[i] = kept.size();
+            if (keep[i]) {
+                kept.push_back(std::move(instructions[i]));
+            }
+        }
+        newIndex[count] = kept.size();
+        size_t removed = count - kept.size();
+        instructions = std::move(kept);
+        for (auto& label : labels) {
+            label.second = newIndex[label.second];
+        }
+        for (Origin& origin : origins) {
+            origin.index = newIndex[origin.index];
+        }
+        
+        assignProvisionalAddresses(origins);
+        
+        if (!quietMode) {
+            std::cout << "Otimização do CFG: " << threaded << " desvio(s) redirecionado(s), "
+                      << removed << " instrução(ões) removida(s)" << std::endl;
+        }
+    }
+    
+    // Layout guiado por perfil (--layout-profile), depois da otimização do CFG e
+    // antes do escalonamento. Os blocos básicos de cada trecho .org são
+    // reordenados para que o sucessor mais executado de um bloco venha logo
+    // depois dele. A contagem de um bloco é a da sua primeira linha no arquivo
+    // de perfil; como não há contagens de arestas, o peso de uma aresta é
+    // estimado a partir das dos blocos. As cadeias de blocos são formadas gulosamente pelas
+    // arestas mais pesadas, dentro de cada função (que começa no trecho e em
+    // cada destino de jal com rd != zero), e seguem em ordem de contagem; os
+    // blocos nunca executados vão para o fim do trecho. Ficam presos ao bloco
+    // anterior o retorno de uma chamada e um bloco sem rótulo que não é
+    // alcançado em sequência (tabelas de saltos, por endereço calculado); o
+    // bloco que cai no fim do trecho continua por último. Depois, desvios cujo
+    // destino passou a ser o bloco seguinte são invertidos, "jal zero" para o
+    // bloco seguinte é removido e um "jal zero" é inserido onde a sequência
+    // antiga deixou de ser o bloco seguinte. Mesmas condições da otimização do
+    // CFG: todo destino de desvio é um rótulo e não há auipc. labels e origins
+    // são reindexados; os blocos sem rótulo que viram destino ganham um rótulo
+    // "@<linha>".
+    void layoutByProfile(std::vector<std::pair<uint32_t, size_t>>& labels, std::vector<Origin>& origins) {
+        const size_t NONE = static_cast<size_t>(-1);
+        size_t count = instructions.size();
+        std::unordered_map<uint32_t, size_t> labelIndex;
+        for (const auto& label : labels) {
+            labelIndex[label.first] = label.second;
+        }
+        std::vector<uint32_t> labelAt(count + 1, SymbolTable::NONE);  // rótulo que marca cada índice
+        for (const auto& label : labels) {
+            if (labelAt[label.second] == SymbolTable::NONE && labelIndex[label.first] == label.second) {
+                labelAt[label.second] = label.first;
+            }
+        }
+        
+        auto destination = [&](size_t i) {
+            return instructions[i].operands.empty() ? -1 : lookupRegister(instructions[i].operands[0]);
+        };
+        std::vector<size_t> target(count, NONE);
+        std::vector<InstructionType> type(count, UNKNOWN);
+        std::vector<bool> callTarget(count + 1, false);
+        std::string skipped;
+        for (size_t i = 0; i < count && skipped.empty(); i++) {
+            const Instruction& instr = instructions[i];
+            auto entry = opcodeTable.find(instr.opcode);
+            if (entry == opcodeTable.end()) {
+                continue;  // a validação reporta
+            }
+            type[i] = entry->second.type;
+            if (instr.opcode == "auipc") {
+                skipped = "auipc na linha " + std::to_string(instr.line);
+                break;
+            }
+            int index = symbolOperandIndex(instr);
+            if ((type[i] != B_TYPE && type[i] != J_TYPE) || index < 0) {
+                continue;
+            }
+            auto label = instr.symbol >= 0 ? labelIndex.find(static_cast<uint32_t>(instr.symbol)) : labelIndex.end();
+            if (label == labelIndex.end()) {
+                skipped = "destino '" + instr.operands[index] + "' na linha " + std::to_string(instr.line);
+                break;
+            }
+            target[i] = label->second;
+            if (type[i] == J_TYPE && destination(i) != 0) {
+                callTarget[target[i]] = true;
+            }
+        }
+        if (!skipped.empty()) {
+            if (!quietMode) {
+                std::cout << "Layout por perfil ignorado: " << skipped << std::endl;
+            }
+            return;
+        }
+        
+        // Blocos básicos, como na otimização do CFG
+        std::vector<bool> leader(count + 1, false);
+        std::vector<bool> boundary(count + 1, false);
+        leader[0] = leader[count] = boundary[0] = true;
+        for (const auto& label : labels) {
+            leader[label.second] = true;
+        }
+        for (const Origin& origin : origins) {
+            leader[origin.index] = boundary[origin.index] = true;
+        }
+        for (size_t i = 0; i < count; i++) {
+            if (target[i] != NONE) {
+                leader[target[i]] = true;
+            }
+            if (type[i] == B_TYPE || type[i] == J_TYPE || instructions[i].opcode == "jalr") {
+                leader[i + 1] = true;
+            }
+        }
+        
+        struct Block {
+            size_t first;
+            size_t end;        // índice após a última instrução
+            size_t region;     // trecho .org
+            size_t function;
+            int line;
+            uint64_t count;
+            size_t taken;      // bloco do destino do desvio ou salto final
+            size_t fall;       // bloco seguinte em sequência, se a execução segue para ele
+            bool conditional;  // termina em desvio condicional
+            bool jump;         // termina em "jal zero"
+            bool fallsOff;     // segue para o fim do trecho: fica por último
+        };
+        std::vector<Block> blocks;
+        std::vector<size_t> blockAt(count + 1, NONE);
+        size_t region = 0;
+        size_t function = 0;
+        for (size_t i = 0; i < count;) {
+            size_t end = i + 1;
+            while (!leader[end]) {
+                end++;
+            }
+            if (boundary[i] && !blocks.empty()) {
+                region++;
+            }
+            if ((boundary[i] || callTarget[i]) && !blocks.empty()) {
+                function++;
+            }
+            auto counted = profileCounts.find(instructions[i].line);
+            uint64_t executions = counted == profileCounts.end() ? 0 : counted->second;
+            blockAt[i] = blocks.size();
+            blocks.push_back({i, end, region, function, instructions[i].line, executions, NONE, NONE,
+                              false, false, false});
+            i = end;
+        }
+        
+        // Cadeias: succ/pred ligam blocos que ficam juntos; chain é uma união
+        // com compressão de caminho, para não fechar ciclos
+        size_t blockCount = blocks.size();
+        std::vector<size_t> succ(blockCount, NONE);
+        std::vector<size_t> pred(blockCount, NONE);
+        std::vector<size_t> chain(blockCount);
+        for (size_t b = 0; b < blockCount; b++) {
+            chain[b] = b;
+        }
+        auto find = [&](size_t b) {
+            while (chain[b] != b) {
+                b = chain[b] = chain[chain[b]];
+            }
+            return b;
+        };
+        auto link = [&](size_t from, size_t to) {
+            succ[from] = to;
+            pred[to] = from;
+            chain[find(to)] = find(from);
+        };
+        
+        for (size_t b = 0; b < blockCount; b++) {
+            Block& block = blocks[b];
+            size_t last = block.end - 1;
+            bool fallsThrough = true;
+            bool pinned = false;
+            if (target[last] != NONE) {
+                block.taken = blockAt[target[last]];  // NONE: rótulo no fim do programa
+                if (type[last] == B_TYPE) {
+                    block.conditional = true;
+                } else if (destination(last) == 0) {
+                    block.jump = true;
+                    fallsThrough = false;
+                } else {
+                    pinned = true;  // chamada: o retorno volta para a instrução seguinte
+                }
+            } else if (instructions[last].opcode == "jalr") {
+                fallsThrough = pinned = destination(last) != 0;
+            }
+            bool sameRegion = b + 1 < blockCount && blocks[b + 1].region == block.region;
+            if (fallsThrough && sameRegion) {
+                block.fall = b + 1;
+            } else if (fallsThrough) {
+                block.fallsOff = true;
+            } else if (sameRegion && labelAt[blocks[b + 1].first] == SymbolTable::NONE) {
+                pinned = true;  // sem rótulo e fora da sequência: só por endereço calculado
+            }
+            if (pinned && sameRegion) {
+                link(b, b + 1);
+            }
+        }
+        
+        // Entrada e fim de cada trecho. Se as ligações obrigatórias já prendem
+        // os dois à mesma cadeia, o trecho fica como está.
+        size_t regionCount = blockCount == 0 ? 0 : blocks.back().region + 1;
+        std::vector<size_t> entryOf(regionCount, NONE);
+        std::vector<size_t> lastOf(regionCount, NONE);
+        for (size_t b = 0; b < blockCount; b++) {
+            if (entryOf[blocks[b].region] == NONE) {
+                entryOf[blocks[b].region] = b;
+            }
+            if (blocks[b].fallsOff) {
+                lastOf[blocks[b].region] = b;
+            }
+        }
+        std::vector<bool> kept(regionCount, false);
+        for (size_t b = 0; b < blockCount; b++) {
+            size_t r = blocks[b].region;
+            if (lastOf[r] != NONE && find(entryOf[r]) == find(lastOf[r]) && find(b) != find(entryOf[r])) {
+                kept[r] = true;
+            }
+        }
+        
+        // Arestas entre blocos executados da mesma função, da mais pesada para a
+        // mais leve. O perfil só conta blocos; o peso de uma aresta sai exato
+        // quando o destino tem um único predecessor (todas as suas execuções
+        // vieram dela, e o resto do bloco seguiu pelo outro lado do desvio).
+        // Sem isso, fica o menor dos dois contadores.
+        std::vector<uint32_t> predecessors(blockCount, 0);
+        for (size_t b = 0; b < blockCount; b++) {
+            if (blocks[b].taken != NONE) {
+                predecessors[blocks[b].taken]++;
+            }
+            if (blocks[b].fall != NONE && blocks[b].fall != blocks[b].taken) {
+                predecessors[blocks[b].fall]++;
+            }
+        }
+        struct Edge {
+            uint64_t weight;
+            size_t from;
+            size_t to;
+        };
+        std::vector<Edge> edges;
+        auto addEdge = [&](size_t from, size_t to, uint64_t weight) {
+            if (to == NONE || blocks[to].region != blocks[from].region || blocks[to].function != blocks[from].function) {
+                return;
+            }
+            if (weight > 0) {
+                edges.push_back({weight, from, to});
+            }
+        };
+        for (size_t b = 0; b < blockCount; b++) {
+            if (succ[b] != NONE || kept[blocks[b].region]) {
+                continue;
+            }
+            const Block& block = blocks[b];
+            size_t taken = block.conditional || block.jump ? block.taken : NONE;
+            uint64_t fallWeight = block.fall == NONE ? 0 : std::min(block.count, blocks[block.fall].count);
+            uint64_t takenWeight = taken == NONE ? 0 : std::min(block.count, blocks[taken].count);
+            if (block.conditional && taken != NONE && block.fall != NONE && taken != block.fall) {
+                if (predecessors[block.fall] == 1) {
+                    takenWeight = std::min(takenWeight, block.count - fallWeight);
+                } else if (predecessors[taken] == 1) {
+                    fallWeight = std::min(fallWeight, block.count - takenWeight);
+                }
+            }
+            // Em empate, a ordem estável favorece a sequência original
+            addEdge(b, block.fall, fallWeight);
+            if (taken != block.fall) {
+                addEdge(b, taken, takenWeight);
+            }
+        }
+        std::stable_sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) {
+            return a.weight > b.weight;
+        });
+        for (const Edge& edge : edges) {
+            size_t r = blocks[edge.from].region;
+            if (succ[edge.from] != NONE || pred[edge.to] != NONE || edge.to == entryOf[r] || blocks[edge.from].fallsOff) {
+                continue;
+            }
+            size_t from = find(edge.from);
+            size_t to = find(edge.to);
+            size_t entry = find(entryOf[r]);
+            size_t last = lastOf[r] == NONE ? NONE : find(lastOf[r]);
+            if (from == to || (from == entry && to == last) || (from == last && to == entry)) {
+                continue;
+            }
+            link(edge.from, edge.to);
+        }
+        
+        // Ordem final de cada trecho: a cadeia da entrada, as cadeias executadas
+        // (por função e, dentro dela, da mais executada para a menos), as frias
+        // na ordem do fonte e, por último, a cadeia que cai no fim do trecho
+        std::vector<uint64_t> heat(blockCount, 0);
+        for (size_t b = 0; b < blockCount; b++) {
+            size_t root = find(b);
+            heat[root] = std::max(heat[root], blocks[b].count);
+        }
+        std::vector<size_t> order;
+        order.reserve(blockCount);
+        size_t coldBlocks = 0;
+        size_t keptRegions = 0;
+        auto append = [&](size_t head) {
+            for (size_t b = head; b != NONE; b = succ[b]) {
+                order.push_back(b);
+                coldBlocks += heat[find(b)] == 0 ? 1 : 0;
+            }
+        };
+        for (size_t r = 0, begin = 0; r < regionCount; r++) {
+            size_t end = begin;
+            while (end < blockCount && blocks[end].region == r) {
+                end++;
+            }
+            if (kept[r]) {
+                for (size_t b = begin; b < end; b++) {
+                    order.push_back(b);
+                }
+                keptRegions++;
+                begin = end;
+                continue;
+            }
+            
+            size_t entry = find(entryOf[r]);
+            size_t last = lastOf[r] == NONE ? NONE : find(lastOf[r]);
+            std::vector<size_t> heads;
+            for (size_t b = begin; b < end; b++) {
+                if (pred[b] == NONE && find(b) != entry && find(b) != last) {
+                    heads.push_back(b);
+                }
+            }
+            std::stable_sort(heads.begin(), heads.end(), [&](size_t a, size_t b) {
+                uint64_t heatA = heat[find(a)];
+                uint64_t heatB = heat[find(b)];
+                if ((heatA == 0) != (heatB == 0)) {
+                    return heatA != 0;
+                }
+                if (heatA == 0 || blocks[a].function != blocks[b].function) {
+                    return blocks[a].function < blocks[b].function;
+                }
+                return heatA > heatB;
+            });
+            append(entryOf[r]);
+            for (size_t head : heads) {
+                append(head);
+            }
+            if (last != NONE && last != entry) {
+                size_t head = lastOf[r];
+                while (pred[head] != NONE) {
+                    head = pred[head];
+                }
+                append(head);
+            }
+            begin = end;
+        }
+        
+        // Reescreve as instruções na nova ordem
+        auto labelOf = [&](size_t b) {
+            size_t first = blocks[b].first;
+            if (labelAt[first] == SymbolTable::NONE) {
+                std::string name = "@" + std::to_string(blocks[b].line);
+                for (int k = 2; symbolTable.find(name) != SymbolTable::NONE; k++) {
+                    name = "@" + std::to_string(blocks[b].line) + "." + std::to_string(k);
+                }
+                labelAt[first] = symbolTable.intern(name);
+                labels.push_back({labelAt[first], first});
+            }
+            return labelAt[first];
+        };
+        auto retarget = [&](Instruction& instr, size_t b) {
+            uint32_t id = labelOf(b);
+            instr.symbol = static_cast<int>(id);
+            instr.operands[symbolOperandIndex(instr)] = symbolTable.name(id);
+        };
+        
+        std::vector<size_t> newIndex(count + 1, 0);
+        std::vector<Instruction> placed;
+        placed.reserve(count + count / 8);
+        size_t moved = 0, inverted = 0, removed = 0, inserted = 0;
+        for (size_t k = 0; k < order.size(); k++) {
+            const Block& block = blocks[order[k]];
+            size_t next = k + 1 < order.size() && blocks[order[k + 1]].region == block.region ? order[k + 1] : NONE;
+            moved += order[k] != k ? 1 : 0;
+            size_t last = block.end - 1;
+            for (size_t i = block.first; i < last; i++) {
+                newIndex[i] = placed.size();
+                placed.push_back(std::move(instructions[i]));
+            }
+            
+            newIndex[last] = placed.size();
+            Instruction& instr = instructions[last];
+            if (block.jump && block.taken != NONE && block.taken == next) {
+                removed++;  // o rótulo do salto passa para a instrução seguinte
+                continue;
+            }
+            size_t fall = block.fall;
+            if (block.conditional && fall != NONE && fall != next && block.taken != NONE && block.taken == next) {
+                instr.opcode = invertedBranch(instr.opcode);
+                retarget(instr, fall);
+                fall = next;
+                inverted++;
+            }
+            int line = instr.line;
+            placed.push_back(std::move(instr));
+            if (fall != NONE && fall != next) {
+                Instruction jump("", "jal", {"zero", ""});
+                retarget(jump, fall);
+                jump.line = line;
+                if (compressionEnabled && isCompressionCandidate(jump)) {
+                    jump.size = 2;
+                }
+                placed.push_back(std::move(jump));
+                inserted++;
+            }
+        }
+        newIndex[count] = placed.size();
+        instructions = std::move(placed);
+        for (auto& label : labels) {
+            label.second = newIndex[label.second];
+        }
+        for (Origin& origin : origins) {
+            origin.index = newIndex[origin.index];
+        }
+        assignProvisionalAddresses(origins);
+        
+        if (!quietMode) {
+            std::cout << "Layout por perfil: " << moved << " de " << blockCount << " bloco(s) em nova posição ("
+                      << coldBlocks << " frio(s)), " << inverted << " desvio(s) invertido(s), " << removed
+                      << " salto(s) removido(s), " << inserted << " inserido(s)";
+            if (keptRegions > 0) {
+                std::cout << ", " << keptRegions << " trecho(s) mantido(s)";
+            }
+            std::cout << std::endl;
+        }
+    }
+    
+    // Erro de sintaxe de validateInstruction; durante o --check vira um
+    // diagnóstico, com o operando (-1: o opcode) para achar a coluna
+    void syntaxError(const Instruction& instr, int operand, const std::string& message) {
+        if (diagnosticSink) {
+            diagnosticSink->push_back({instr.line, operand, message});
+            return;
+        }
+        *errors << "Erro de sintaxe na linha " << instr.line << ": " << message << std::endl;
+    }
+    
+    // Função para verificar a sintaxe das instruções assembly. Sem checkTarget,
+    // o destino de desvios e saltos não é avaliado (o --check resolve os
+    // rótulos depois, com o arquivo inteiro).
+    bool validateInstruction(const Instruction& instr, bool checkTarget = true) {
+        bool isValid = true;
+        
+        // Pular instruções vazias 
+        if (instr.opcode.empty()) {
+            return true;
+        }
+        
+        // Verificar se o opcode existe
+        if (opcodeTable.find(instr.opcode) == opcodeTable.end()) {
+            syntaxError(instr, -1, "Opcode desconhecido '" + instr.opcode + "'");
+            return false;
+        }
+        
+        // Verifica se há operandos suficientes
+        size_t minOperands = 0;
+        InstructionType type = opcodeTable[instr.opcode].type;
+        
+        switch (type) {
+            case R_TYPE:
+                minOperands = 3;  // rd, rs1, rs2
+                break;
+            case I_TYPE:
+                if (instr.opcode == "jalr") {
+                    minOperands = 2;  // rd, rs1[, imm]
+                } else if (instr.opcode.find("l") == 0) {  // Instruções load
+                    minOperands = 2;  // rd, offset(rs1)
+                } else {
+                    minOperands = 3;  // rd, rs1, imm
+                }
+                break;
+            case S_TYPE:
+                minOperands = 2;  // rs2, offset(rs1)
+                break;
+            case B_TYPE:
+                minOperands = 3;  // rs1, rs2, offset
+                break;
+            case U_TYPE:
+                minOperands = 2;  // rd, imm
+                break;
+            case J_TYPE:
+                minOperands = 2;  // rd, offset
+                break;
+            default:
+                break;
+        }
+        
+        if (instr.operands.size() < minOperands) {
+            syntaxError(instr, -1, "Número insuficiente de operandos para '" + instr.opcode +
+                        "'. Esperado: " + std::to_string(minOperands) +
+                        ", Encontrado: " + std::to_string(instr.operands.size()));
+            return false;
+        }
+        
+        // Verificar registradores válidos
+        for (size_t j = 0; j < instr.operands.size(); j++) {
+            const std::string& op = instr.operands[j];
+            
+            // Verifica apenas operandos que devem ser registradores
+            bool shouldBeRegister = false;
+            
+            switch (type) {
+                case R_TYPE:
+                    shouldBeRegister = true;  // Todos os operandos são registradores
+                    break;
+                case I_TYPE:
+                    if (j < 2) shouldBeRegister = true;  // rd, rs1 são registradores
+                    break;
+                case S_TYPE:
+                    if (j < 2) shouldBeRegister = true;  // rs2 e offset(rs1)
+                    break;
+                case B_TYPE:
+                    if (j < 2) shouldBeRegister = true;  // rs1, rs2 são registradores
+                    break;
+                case U_TYPE:
+                case J_TYPE:
+                    if (j == 0) shouldBeRegister = true;  // rd é registrador
+                    break;
+                default:
+                    break;
+            }
+            
+            // Operando de memória no formato offset(rs1) (loads, stores e jalr)
+            bool isMemoryOperand = (j == 1) &&
+                (type == S_TYPE || (type == I_TYPE && instr.opcode.find("l") == 0) ||
+                 op.find('(') != std::string::npos);
+            
+            if (shouldBeRegister) {
+                if (isMemoryOperand) {
+                    std::string offset, rs1Str;
+                    if (splitMemoryOperand(op, offset, rs1Str)) {
+                        if (getRegisterNumber(rs1Str) == -1) {
+                            syntaxError(instr, static_cast<int>(j), "Registrador inválido '" + rs1Str + "' em '" + op + "'");
+                            isValid = false;
+                        }
+                    } else {
+                        syntaxError(instr, static_cast<int>(j), "Formato inválido para instrução de store/load: '" + op +
+                                    "', esperado formato 'offset(rs1)'");
+                        isValid = false;
+                    }
+                } else {
+                    if (getRegisterNumber(op) == -1) {
+                        syntaxError(instr, static_cast<int>(j), "Registrador inválido '" + op + "'");
+                        isValid = false;
+                    }
+                }
+            }
+        }
+        
+        // Verificações específicas para tipos de instrução
+        if (checkTarget && (type == B_TYPE || type == J_TYPE)) {
+            const std::string& label = instr.operands[instr.operands.size() - 1];
+            
+            int64_t value = 0;
+            bool hasSymbol = false;
+            std::string error;
+            if (!evaluateImmediate(instr, label, value, hasSymbol, error)) {
+                syntaxError(instr, static_cast<int>(instr.operands.size() - 1), error);
+                isValid = false;
+            }
+        }
+        
+        return isValid;
+    }
+    
+    bool validateSyntax() {
+        bool isValid = true;
+        for (const Instruction& instr : instructions) {
+            if (!validateInstruction(instr)) {
+                isValid = false;
+            }
+        }
+        return isValid;
+    }
+    
+    // Trechos do --check: terminam na primeira linha cujo hash tem os bits de
+    // CHECK_CHUNK_MASK zerados depois de CHECK_CHUNK_MIN linhas, ou em
+    // CHECK_CHUNK_MAX linhas. A fronteira depende só do conteúdo, então editar
+    // uma linha muda o trecho dela e no máximo o seguinte.
+    static const int CHECK_CHUNK_MIN = 16;
+    static const int CHECK_CHUNK_MAX = 1024;
+    static const uint64_t CHECK_CHUNK_MASK = 63;
+    
+    // Hash de 64 bits, 8 bytes por passo
+    static uint64_t hashBytes(const char* data, size_t size) {
+        const uint64_t K = 0x9E3779B97F4A7C15ULL;
+        uint64_t h = size * K;
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, data + i, 8);
+            h = (h ^ word) * K;
+            h ^= h >> 32;
+        }
+        uint64_t tail = 0;
+        std::memcpy(&tail, data + i, size - i);
+        h = (h ^ tail) * K;
+        return h ^ (h >> 29);
+    }
+    
+    // Coluna (a partir de 1) do opcode (operand = -1) ou de um operando de instr
+    // na linha line[0, length), já sem comentário. Operandos que não aparecem
+    // no texto (inseridos por pseudoinstruções) ficam na coluna do opcode.
+    static int sourceColumn(const char* line, size_t length, const Instruction& instr, int operand) {
+        size_t pos = 0;
+        if (!instr.label.empty()) {
+            const char* colon = findUnquoted(line, length, ':');
+            pos = colon ? static_cast<size_t>(colon - line) + 1 : 0;
+        }
+        while (pos < length && isSpace(line[pos])) pos++;
+        int opcodeColumn = static_cast<int>(pos) + 1;
+        if (operand < 0 || static_cast<size_t>(operand) >= instr.operands.size()) {
+            return opcodeColumn;
+        }
+        
+        while (pos < length && !isSpace(line[pos])) pos++;
+        auto isWordChar = [](char c) {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.' || c == '$';
+        };
+        const std::string& text = instr.operands[operand];
+        const char* end = line + length;
+        for (const char* found = line + pos;; found++) {
+            found = std::search(found, end, text.begin(), text.end());
+            if (found == end) {
+                return opcodeColumn;
+            }
+            const char* after = found + text.size();
+            if ((found == line || !isWordChar(found[-1])) && (after == end || !isWordChar(*after))) {
+                return static_cast<int>(found - line) + 1;
+            }
+        }
+    }
+    
+    // Analisa um trecho do --check (marks: posições estruturais relativas a
+    // data): tudo o que não depende de outras linhas, incluindo literais e a
+    // faixa dos imediatos numéricos. Imediatos com rótulos, rótulos locais e
+    // .org ficam como eventos, resolvidos por check com o arquivo inteiro.
+    std::shared_ptr<const CheckChunk> analyzeChunk(const char* data, size_t size, const std::vector<uint32_t>& marks) {
+        auto chunk = std::make_shared<CheckChunk>();
+        chunk->text.assign(data, size);
+        
+        std::vector<PendingDiagnostic> pending;
+        std::vector<Instruction> loads;
+        diagnosticSink = &pending;
+        const char* line = data;
+        int lineNumber = 0;
+        forEachLine(data, size, marks, [&](Instruction& instr) {
+            const char* newline = static_cast<const char*>(std::memchr(line, '\n', data + size - line));
+            size_t length = static_cast<size_t>((newline ? newline : data + size) - line);
+            const char* comment = findUnquoted(line, length, '#');
+            if (comment) {
+                length = static_cast<size_t>(comment - line);
+            }
+            auto flush = [&](const Instruction& source) {
+                for (const PendingDiagnostic& diagnostic : pending) {
+                    chunk->diagnostics.push_back({diagnostic.line, sourceColumn(line, length, source, diagnostic.operand),
+                                                  diagnostic.message});
+                }
+                pending.clear();
+            };
+            // Imediato text do operando index: sintaxe e literais aqui; a faixa
+            // só sem rótulos (com rótulos, o valor depende do arquivo inteiro)
+            auto checkImmediate = [&](const Instruction& source, int index, const std::string& text, int64_t min,
+                                      int64_t max, int64_t align) {
+                int column = sourceColumn(line, length, source, index);
+                if (isLocalLabelReference(text) && index == symbolOperandIndex(source)) {
+                    chunk->events.push_back({CheckChunk::LOCAL_REFERENCE, source.line, column, text});
+                    return;
+                }
+                int64_t value = 0;
+                bool symbol = false;
+                std::string message;
+                if (!ImmediateParser::checkSyntax(text, value, symbol, message)) {
+                    syntaxError(source, index, message);
+                } else if (symbol) {
+                    chunk->events.push_back({CheckChunk::REFERENCE, source.line, column, text});
+                } else if (value < min || value > max || value % align != 0) {
+                    syntaxError(source, index, rangeMessage(source.opcode, value, min, max, align));
+                }
+            };
+            instr.line = ++lineNumber;
+            
+            if (!instr.label.empty()) {
+                if (isLocalLabel(instr.label)) {
+                    chunk->events.push_back({CheckChunk::LOCAL_DEFINITION, instr.line, 1, instr.label});
+                } else {
+                    chunk->labels.push_back(instr.label);
+                }
+            }
+            
+            if (instr.opcode == ".org") {
+                chunk->events.push_back({CheckChunk::ORIGIN, instr.line, sourceColumn(line, length, instr, -1), ""});
+                chunk->origins.push_back(instr);
+            } else if (instr.opcode == "li" || instr.opcode == "la") {
+                bool pendingLoad = false;
+                if (instr.operands.size() == 2 && isLocalLabelReference(instr.operands[1])) {
+                    chunk->events.push_back({CheckChunk::LOCAL_REFERENCE, instr.line,
+                                             sourceColumn(line, length, instr, 1), instr.operands[1]});
+                } else if (expandConstantLoad(instr, loads, pendingLoad)) {
+                    for (const Instruction& part : loads) {
+                        validateInstruction(part, false);
+                        flush(part);
+                    }
+                    // A expansão já conferiu os 32 bits de um valor numérico; falta a
+                    // sintaxe de uma expressão não avaliada e os rótulos dela
+                    checkImmediate(instr, 1, instr.operands[1], INT32_MIN, UINT32_MAX, 1);
+                }
+                flush(instr);
+            } else if (!instr.opcode.empty()) {
+                validateInstruction(instr, false);
+                
+                // Destinos de desvio com rótulo viram eventos; offsets numéricos e
+                // demais imediatos são conferidos contra a faixa do campo
+                std::string text;
+                int64_t min = 0, max = 0, align = 1;
+                int index = immediateOperand(instr, text, min, max, align);
+                if (index >= 0) {
+                    checkImmediate(instr, index, text, min, max, align);
+                }
+                flush(instr);
+            }
+            line = newline ? newline + 1 : data + size;
+        });
+        diagnosticSink = nullptr;
+        chunk->lines = lineNumber;
+        return chunk;
+    }
+    
+public:
+    Assembler(const std::string& input, const std::string& output = "memoria.mif")
+        : inputFile(input), outputFile(output), debugMode(false), quietMode(false),
+          quartusOutput(false), scheduleEnabled(false), compressionEnabled(false), cfgOptimization(false),
+          profileLayout(false), errors(&std::cerr), diagnosticSink(nullptr) {
+    }
+    
+    void setDebugMode(bool enable) {
+        debugMode = enable;
+    }
+    
+    void setQuietMode(bool enable) {
+        quietMode = enable;
+    }
+    
+    // Grava o .mif no formato do Quartus mesmo quando a imagem é densa
+    void setQuartusOutput(bool enable) {
+        quartusOutput = enable;
+    }
+    
+    // Ativa a reordenação de instruções por bloco básico segundo o modelo de pipeline
+    void enableScheduling(const PipelineModel& model) {
+        scheduleEnabled = true;
+        scheduleModel = model;
+    }
+    
+    void disableScheduling() {
+        scheduleEnabled = false;
+    }
+    
+    // Emite instruções elegíveis na forma comprimida de 16 bits
+    void setCompression(bool enable) {
+        compressionEnabled = enable;
+    }
+    
+    // Otimiza o grafo de fluxo de controle antes do layout
+    void setCfgOptimization(bool enable) {
+        cfgOptimization = enable;
+    }
+    
+    // Lê as contagens de execução por linha (gravadas por --profile --counts)
+    // e ativa o layout guiado por perfil: "<linha> <execuções>" por linha,
+    // com "#" e "arquivo ..." ignorados
+    bool loadLayoutProfile(const std::string& path) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            *errors << "Erro: Não foi possível abrir o perfil: " << path << std::endl;
+            return false;
+        }
+        profileCounts.clear();
+        std::string text;
+        int lineNumber = 0;
+        while (std::getline(file, text)) {
+            lineNumber++;
+            if (text.empty() || text[0] == '#' || text.compare(0, 8, "arquivo ") == 0) {
+                continue;
+            }
+            std::istringstream fields(text);
+            int line = 0;
+            uint64_t executions = 0;
+            if (!(fields >> line >> executions) || line <= 0) {
+                *errors << "Erro: Linha " << lineNumber << " inválida no perfil " << path << std::endl;
+                profileCounts.clear();
+                return false;
+            }
+            profileCounts[line] += executions;
+        }
+        profileLayout = true;
+        return true;
+    }
+    
+    void clearLayoutProfile() {
+        profileLayout = false;
+        profileCounts.clear();
+    }
+    
+    // Usa um cache de trechos do --check compartilhado (no servidor, entre as threads)
+    void setCheckCache(std::shared_ptr<CheckCache> cache) {
+        checkCache = std::move(cache);
+    }
+    
+    // Redireciona as mensagens de erro (por exemplo, para devolvê-las a um cliente)
+    void setDiagnosticStream(std::ostream& stream) {
+        errors = &stream;
+    }
+    
+    // Retorna a imagem de memória gerada pela segunda passagem
+    const MemoryImage& getImage() const {
+        return image;
+    }
+    
+    const std::vector<Instruction>& getInstructions() const {
+        return instructions;
+    }
+    
+    const SymbolTable& getSymbolTable() const {
+        return symbolTable;
+    }
+    
+    // Grava a tabela endereço -> (arquivo, linha, rótulo) da última montagem.
+    // Instruções consecutivas em linhas consecutivas sob o mesmo rótulo viram
+    // uma única faixa "início fim arquivo linha rótulo" (endereços em hex).
+    bool writeLineTable(const std::string& path) const {
+        std::ofstream file(path);
+        if (!file.is_open()) {
+            *errors << "Erro: Não foi possível abrir o arquivo de saída: " << path << std::endl;
+            return false;
+        }
+        
+        // Rótulo mais próximo em ou antes de cada endereço
+        std::map<uint32_t, std::string> labelsByAddress;
+        symbolTable.forEach([&](const std::string& name, int value) {
+            auto it = labelsByAddress.find(static_cast<uint32_t>(value));
+            if (it == labelsByAddress.end() || name < it->second) {
+                labelsByAddress[static_cast<uint32_t>(value)] = name;
+            }
+        });
+        
+        file << "# myRV32I: tabela endereço -> fonte" << std::endl;
+        file << "# <início> <fim> <arquivo> <linha> <rótulo>" << std::endl;
+        file << "arquivo 0 " << (inputFile.empty() ? "<memória>" : inputFile) << std::endl;
+        
+        auto labelIt = labelsByAddress.begin();
+        std::string currentLabel = "-";
+        size_t count = image.empty() ? 0 : instructions.size();
+        size_t start = 0;
+        std::string startLabel;
+        
+        for (size_t i = 0; i <= count; i++) {
+            int64_t address = i < count ? instructions[i].address : 0;
+            bool labelChanged = false;
+            while (i < count && labelIt != labelsByAddress.end() && labelIt->first <= address) {
+                currentLabel = labelIt->second;
+                labelChanged = true;
+                ++labelIt;
+            }
+            
+            // Fecha a faixa aberta quando a sequência de linhas, o rótulo ou o
+            // trecho de endereços (.org) mudam. Instruções comprimidas e desvios
+            // relaxados ficam em faixas próprias, para que cada faixa tenha passo
+            // fixo de 4 bytes; a faixa de um desvio relaxado cobre todas as partes.
+            bool extends = i < count && i > start && !labelChanged &&
+                           instructions[i].line == instructions[i - 1].line + 1 &&
+                           instructions[i].size == 4 && instructions[i - 1].size == 4 &&
+                           instructions[i].address == instructions[i - 1].address + 4;
+            if (i > start && !extends) {
+                file << std::hex << std::setw(8) << std::setfill('0') << instructions[start].address << ' '
+                     << std::setw(8) << instructions[i - 1].address + std::max<uint32_t>(instructions[i - 1].size, 4) - 4
+                     << std::dec << std::setfill(' ')
+                     << " 0 " << instructions[start].line << ' ' << startLabel << '\n';
+                start = i;
+            }
+            if (i == start) {
+                startLabel = currentLabel;
+            }
+        }
+        return true;
+    }
+    
+    // Registradores lidos/escritos e destino de desvio de cada instrução da
+    // primeira passagem. Deve ser chamada após firstPass e validateSyntax.
+    std::vector<InstructionInfo> analyzeInstructions() {
+        std::vector<InstructionInfo> result(instructions.size());
+        for (size_t i = 0; i < instructions.size(); i++) {
+            describeInstruction(instructions[i], instructions[i].address, result[i]);
+        }
+        return result;
+    }
+    
+    // Formas de carregar uma constante de 32 bits, da menor para a mais geral
+    enum LoadForm {
+        LOAD_ADDI,  // addi rd, zero, valor
+        LOAD_LUI,   // lui rd, %hi(valor), com os 12 bits baixos em zero
+        LOAD_BOTH   // lui rd, %hi(valor) + addi rd, rd, %lo(valor)
+    };
+    
+    static LoadForm loadFormFor(int64_t value) {
+        uint32_t bits = static_cast<uint32_t>(value);
+        int32_t signedValue = static_cast<int32_t>(bits);
+        if (signedValue >= -2048 && signedValue <= 2047) {
+            return LOAD_ADDI;
+        }
+        return (bits & 0xFFF) == 0 ? LOAD_LUI : LOAD_BOTH;
+    }
+    
+    static LoadForm currentLoadForm(const Instruction& high, const Instruction& low) {
+        return high.size == 0 ? LOAD_ADDI : (low.size == 0 ? LOAD_LUI : LOAD_BOTH);
+    }
+    
+    // Aplica a forma ao par lui/addi de um li/la com rótulo. A parte que não
+    // entra na forma fica com tamanho 0 e é removida por dropOmitted; a que
+    // passa a existir começa comprimida quando puder, como as demais.
+    void setLoadForm(Instruction& high, Instruction& low, LoadForm form) {
+        auto include = [this](Instruction& instr) {
+            if (instr.size == 0) {
+                instr.size = (compressionEnabled && isCompressionCandidate(instr)) ? 2 : 4;
+            }
+        };
+        std::string rd = high.operands[0];
+        if (form == LOAD_ADDI) {
+            high.size = 0;
+            low.operands = {rd, "zero", low.constant};
+            include(low);
+        } else if (form == LOAD_LUI) {
+            include(high);
+            low.size = 0;
+        } else {
+            include(high);
+            low.operands = {rd, rd, "%lo(" + low.constant + ")"};
+            include(low);
+        }
+    }
+    
+    // Expande "li rd, valor" e "la rd, rótulo" na menor sequência que carrega o
+    // valor de 32 bits: addi, lui ou lui + addi, com o carry de %lo compensado
+    // em %hi. Um valor numérico é expandido aqui mesmo. Um valor que depende de
+    // rótulos vira um par lui/addi marcado com a expressão: se os rótulos já têm
+    // valor, a forma segue esse valor; senão começa só com o addi (pending) e
+    // cresce em layoutInstructions.
+    bool expandConstantLoad(const Instruction& instr, std::vector<Instruction>& out, bool& pending) {
+        out.clear();
+        pending = false;
+        if (instr.operands.size() != 2) {
+            reportError(instr, instr.opcode + " espera um registrador e um valor");
+            return false;
+        }
+        const std::string& rd = instr.operands[0];
+        const std::string& expression = instr.operands[1];
+        
+        int64_t value = 0;
+        ImmediateParser parser(symbolTable);
+        bool known = parser.evaluate(expression, value);
+        if (known && !parser.usedSymbol()) {
+            if (value < INT32_MIN || value > static_cast<int64_t>(UINT32_MAX)) {
+                reportError(instr, "Valor fora de 32 bits para " + instr.opcode + ": " + std::to_string(value));
+                return false;
+            }
+            uint32_t bits = static_cast<uint32_t>(value);
+            int32_t low = static_cast<int32_t>(((bits & 0xFFF) ^ 0x800)) - 0x800;
+            LoadForm form = loadFormFor(value);
+            if (form == LOAD_ADDI) {
+                out.push_back(Instruction(instr.label, "addi", {rd, "zero", std::to_string(low)}));
+            } else {
+                std::ostringstream upper;
+                upper << "0x" << std::hex << (((bits - static_cast<uint32_t>(low)) >> 12) & 0xFFFFF);
+                out.push_back(Instruction(instr.label, "lui", {rd, upper.str()}));
+                if (form == LOAD_BOTH) {
+                    out.push_back(Instruction("", "addi", {rd, rd, std::to_string(low)}));
+                }
+            }
+        } else {
+            // Rótulos ainda sem valor ficam para o layout; erros de sintaxe não
+            std::string message;
+            int64_t ignored = 0;
+            bool symbol = false;
+            if (!ImmediateParser::checkSyntax(expression, ignored, symbol, message)) {
+                syntaxError(instr, 1, message);
+                return false;
+            }
+            Instruction high(instr.label, "lui", {rd, "%hi(" + expression + ")"});
+            Instruction low("", "addi", {});
+            high.constant = low.constant = expression;
+            high.size = low.size = 0;
+            setLoadForm(high, low, LOAD_ADDI);
+            if (known) {
+                setLoadForm(high, low, loadFormFor(value));
+            } else {
+                pending = true;
+            }
+            out.push_back(std::move(high));
+            out.push_back(std::move(low));
+        }
+        for (Instruction& part : out) {
+            part.line = instr.line;
+        }
+        return true;
+    }
+    
+    // Ajusta cada li/la com rótulo ao valor com os endereços atuais. As formas
+    // só avançam (addi -> lui -> lui + addi), então o layout termina. Retorna
+    // se alguma forma mudou; included recebe as partes que passaram a existir
+    // já comprimidas.
+    bool resizeConstantLoads(std::vector<size_t>& included) {
+        bool changed = false;
+        for (size_t i = 0; i + 1 < instructions.size(); i++) {
+            Instruction& high = instructions[i];
+            if (high.constant.empty() || high.opcode != "lui") {
+                continue;
+            }
+            Instruction& low = instructions[++i];
+            int64_t value = 0;
+            ImmediateParser parser(symbolTable);
+            if (!parser.evaluate(high.constant, value)) {
+                continue;  // o erro aparece ao codificar o addi
+            }
+            LoadForm current = currentLoadForm(high, low);
+            LoadForm needed = loadFormFor(value);
+            LoadForm next = current;
+            if (current == LOAD_ADDI && needed != LOAD_ADDI) {
+                next = needed;
+            } else if (current == LOAD_LUI && needed != LOAD_LUI) {
+                next = LOAD_BOTH;
+            }
+            if (next != current) {
+                bool hadHigh = high.size != 0;
+                bool hadLow = low.size != 0;
+                setLoadForm(high, low, next);
+                if (!hadHigh && high.size == 2) {
+                    included.push_back(i - 1);
+                }
+                if (!hadLow && low.size == 2) {
+                    included.push_back(i);
+                }
+                changed = true;
+            }
+        }
+        return changed;
+    }
+    
+    // Remove as partes de tamanho 0 dos li/la, depois do layout; o rótulo da
+    // linha passa para a parte que ficou
+    void dropOmitted() {
+        size_t kept = 0;
+        for (size_t i = 0; i < instructions.size(); i++) {
+            if (instructions[i].size == 0) {
+                if (i + 1 < instructions.size() && instructions[i + 1].label.empty()) {
+                    instructions[i + 1].label = instructions[i].label;
+                }
+                continue;
+            }
+            if (kept != i) {
+                instructions[kept] = std::move(instructions[i]);
+            }
+            kept++;
+        }
+        instructions.resize(kept);
+    }
+    
+    // Relaxamento de desvios: o tamanho da instrução indica a forma usada.
+    //   desvio condicional, 8 bytes:  desvio inverso +8;  jal zero, alvo
+    //   desvio condicional, 12 bytes: desvio inverso +12; auipc t1, %hi; jalr zero, t1, %lo
+    //   jal, 8 bytes:                 auipc rd, %hi; jalr rd, rd, %lo (t1 quando rd é zero, como em tail)
+    // Só desvios com rótulo são relaxados; offsets numéricos e c.* explícitos
+    // ficam como escritos.
+    static const int64_t BRANCH_MIN = -4096;
+    static const int64_t BRANCH_MAX = 4094;
+    static const int64_t JAL_MIN = -1048576;
+    static const int64_t JAL_MAX = 1048574;
+    
+    // Offset do alvo simbólico de um desvio ou jal, a partir da instrução.
+    // Falso se a instrução não pode ser relaxada ou se o alvo não tem valor.
+    bool relaxableOffset(const Instruction& instr, int64_t& offset) const {
+        if (instr.forceCompressed || instr.size == 2) {
+            return false;
+        }
+        auto entry = opcodeTable.find(instr.opcode);
+        int index = symbolOperandIndex(instr);
+        if (entry == opcodeTable.end() || index < 0 ||
+            (entry->second.type != B_TYPE && entry->second.type != J_TYPE)) {
+            return false;
+        }
+        bool hasSymbol = false;
+        std::string error;
+        if (!evaluateImmediate(instr, instr.operands[index], offset, hasSymbol, error) || !hasSymbol) {
+            return false;
+        }
+        offset = static_cast<int32_t>(static_cast<uint32_t>(offset - instr.address));
+        return true;
+    }
+    
+    // Menor forma que alcança o offset (4, 8 ou 12 bytes)
+    static uint32_t relaxedSize(bool conditional, int64_t offset) {
+        if (!conditional) {
+            return offset >= JAL_MIN && offset <= JAL_MAX ? 4 : 8;
+        }
+        if (offset >= BRANCH_MIN && offset <= BRANCH_MAX) {
+            return 4;
+        }
+        return offset - 4 >= JAL_MIN && offset - 4 <= JAL_MAX ? 8 : 12;
+    }
+    
+    // Quanto o offset ainda pode mudar sem sair do alcance da forma atual
+    // (UINT64_MAX para auipc + jalr, que alcança todo o espaço de endereços)
+    static uint64_t relaxationSlack(bool conditional, uint32_t size, int64_t offset) {
+        if (conditional && size == 4) {
+            return static_cast<uint64_t>(std::min(offset - BRANCH_MIN, BRANCH_MAX - offset));
+        }
+        if ((conditional && size == 8) || (!conditional && size == 4)) {
+            int64_t jump = conditional ? offset - 4 : offset;
+            return static_cast<uint64_t>(std::min(jump - JAL_MIN, JAL_MAX - jump));
+        }
+        return UINT64_MAX;
+    }
+    
+    // Desvio condicional com a condição oposta (beq <-> bne, blt <-> bge, bltu <-> bgeu)
+    static std::string invertedBranch(const std::string& opcode) {
+        static const char* const pairs[][2] = {
+            {"beq", "bne"}, {"bne", "beq"}, {"blt", "bge"}, {"bge", "blt"}, {"bltu", "bgeu"}, {"bgeu", "bltu"},
+        };
+        for (const auto& pair : pairs) {
+            if (opcode == pair[0]) {
+                return pair[1];
+            }
+        }
+        return "";
+    }
+    
+    // Expande um desvio relaxado (size 8 ou 12) nas instruções de 32 bits que o
+    // formam, com offsets numéricos e o endereço de cada parte
+    bool expandRelaxed(const Instruction& instr, std::vector<Instruction>& out) {
+        out.clear();
+        int64_t offset = 0;
+        if (!relaxableOffset(instr, offset)) {
+            reportError(instr, "Desvio relaxado sem destino: " + instr.toString());
+            return false;
+        }
+        bool conditional = opcodeTable[instr.opcode].type == B_TYPE;
+        if (conditional) {
+            out.push_back(Instruction("", invertedBranch(instr.opcode),
+                                      {instr.operands[0], instr.operands[1], std::to_string(instr.size)}));
+            offset -= 4;
+        }
+        if (conditional && instr.size == 8) {
+            out.push_back(Instruction("", "jal", {"zero", std::to_string(offset)}));
+        } else {
+            uint32_t bits = static_cast<uint32_t>(offset);
+            int32_t low = static_cast<int32_t>(((bits & 0xFFF) ^ 0x800)) - 0x800;
+            std::ostringstream upper;
+            upper << "0x" << std::hex << (((bits - static_cast<uint32_t>(low)) >> 12) & 0xFFFFF);
+            std::string rd = conditional ? "zero" : instr.operands[0];
+            std::string base = lookupRegister(rd) == 0 ? "t1" : rd;
+            out.push_back(Instruction("", "auipc", {base, upper.str()}));
+            out.push_back(Instruction("", "jalr", {rd, base, std::to_string(low)}));
+        }
+        for (size_t i = 0; i < out.size(); i++) {
+            out[i].line = instr.line;
+            out[i].address = instr.address + static_cast<uint32_t>(4 * i);
+        }
+        return true;
+    }
+    
+    // Algum operando usa um rótulo: a codificação muda com os endereços
+    bool dependsOnLabels(const Instruction& instr) const {
+        if (instr.symbol >= 0) {
+            return true;
+        }
+        bool found = false;
+        for (const std::string& operand : instr.operands) {
+            ImmediateParser::forEachSymbolName(operand, [&](const std::string& name) {
+                found = found || symbolTable.find(name) != SymbolTable::NONE;
+            });
+        }
+        return found;
+    }
+    
+    // Desvio que precisa de uma forma maior que a atual, com os rótulos atuais
+    bool needsRelaxation(const Instruction& instr) const {
+        int64_t offset = 0;
+        return relaxableOffset(instr, offset) &&
+               relaxedSize(opcodeTable.at(instr.opcode).type == B_TYPE, offset) > instr.size;
+    }
+    
+    // Atribui os endereços finais e registra os rótulos na tabela de símbolos.
+    // Com compressão, as candidatas começam com 2 bytes; a cada rodada, as que
+    // não têm mais forma comprimida com os endereços atuais (um desvio que ficou
+    // longe demais, por exemplo) passam a 4 bytes. Desvios com rótulo fora do
+    // alcance crescem para a forma relaxada. Os tamanhos só crescem, então o
+    // laço termina; em código comum, bastam duas ou três rodadas.
+    //
+    // Como os tamanhos só crescem, a distância entre um desvio e o alvo muda no
+    // máximo o quanto o código todo cresceu. Cada desvio guarda o tamanho total
+    // a partir do qual pode ter saído do alcance, e só é reavaliado quando o
+    // código passa desse limite: nas rodadas seguintes à primeira, só os
+    // desvios perto da borda do alcance são olhados de novo.
+    bool layoutInstructions(const std::vector<std::pair<uint32_t, size_t>>& labels,
+                            const std::vector<Origin>& origins) {
+        size_t count = instructions.size();
+        struct Candidate {
+            size_t index;
+            uint64_t limit;  // tamanho total do código a partir do qual é reavaliado
+        };
+        std::vector<Candidate> candidates;
+        for (size_t i = 0; i < count; i++) {
+            const Instruction& instr = instructions[i];
+            if (instr.forceCompressed || symbolOperandIndex(instr) < 0) {
+                continue;
+            }
+            InstructionType type = opcodeTable[instr.opcode].type;
+            if (type == B_TYPE || type == J_TYPE) {
+                candidates.push_back({i, 0});
+            }
+        }
+        size_t relaxed = 0;
+        size_t compressed = 0;           // comprimidas sem rótulo: valem em qualquer endereço
+        std::vector<size_t> labelUsers;  // comprimidas cujo imediato depende de rótulos
+        
+        for (int round = 1; ; round++) {
+            uint64_t location = 0;
+            uint64_t totalSize = 0;
+            size_t nextOrigin = 0;
+            auto applyOrigins = [&](size_t index) {
+                for (; nextOrigin < origins.size() && origins[nextOrigin].index == index; nextOrigin++) {
+                    const Origin& origin = origins[nextOrigin];
+                    if (location > origin.address) {
+                        std::ostringstream message;
+                        message << "Erro na linha " << origin.line << ": .org 0x" << std::hex << origin.address
+                                << " fica antes do fim do código anterior (0x" << location << ")" << std::dec;
+                        *errors << message.str() << std::endl;
+                        return false;
+                    }
+                    location = origin.address;
+                }
+                return true;
+            };
+            
+            for (size_t i = 0; i < count; i++) {
+                if (!applyOrigins(i)) {
+                    return false;
+                }
+                if (location + instructions[i].size > 0x100000000ULL) {
+                    reportError(instructions[i], "Instrução além do fim do espaço de endereçamento");
+                    return false;
+                }
+                instructions[i].address = static_cast<uint32_t>(location);
+                location += instructions[i].size;
+                totalSize += instructions[i].size;
+            }
+            if (!applyOrigins(count)) {
+                return false;
+            }
+            
+            for (const auto& label : labels) {
+                uint64_t address = label.second < count ? instructions[label.second].address : location;
+                symbolTable.define(label.first, static_cast<int>(static_cast<uint32_t>(address)));
+            }
+            
+            std::vector<size_t> included;
+            bool reshaped = resizeConstantLoads(included);
+            size_t grown = 0;
+            uint16_t half = 0;
+            if (compressionEnabled && round == 1) {
+                for (size_t i = 0; i < count; i++) {
+                    Instruction& instr = instructions[i];
+                    if (instr.size != 2 || instr.forceCompressed) {
+                        continue;
+                    }
+                    if (!compressInstruction(instr, half)) {
+                        instr.size = 4;
+                        grown++;
+                    } else if (dependsOnLabels(instr)) {
+                        labelUsers.push_back(i);
+                    } else {
+                        compressed++;  // a forma comprimida não depende dos endereços
+                    }
+                }
+            }
+            
+            // Nas rodadas seguintes, só as comprimidas com rótulo podem deixar de caber
+            size_t kept = 0;
+            for (size_t index : labelUsers) {
+                Instruction& instr = instructions[index];
+                if (round > 1 && !compressInstruction(instr, half)) {
+                    instr.size = 4;
+                    grown++;
+                } else {
+                    labelUsers[kept++] = index;
+                }
+            }
+            labelUsers.resize(kept);
+            
+            // Partes de li/la que passaram a existir nesta rodada (a primeira já
+            // passou por todas): também começam comprimidas e dependem de rótulos
+            for (size_t index : included) {
+                if (round > 1 && !compressInstruction(instructions[index], half)) {
+                    instructions[index].size = 4;
+                    grown++;
+                } else if (round > 1) {
+                    labelUsers.push_back(index);
+                }
+            }
+            if (debugMode && compressionEnabled) {
+                std::cout << "Layout, rodada " << round << ": " << compressed + labelUsers.size() << " instruções comprimidas, "
+                          << grown << " voltaram a 32 bits" << std::endl;
+            }
+            if (debugMode && reshaped) {
+                std::cout << "Layout, rodada " << round << ": li/la com rótulo mudaram de tamanho" << std::endl;
+            }
+            
+            // Relaxamento: só os desvios cujo limite o código já alcançou
+            size_t revisited = 0;
+            size_t widened = 0;
+            for (Candidate& candidate : candidates) {
+                if (candidate.limit > totalSize) {
+                    continue;
+                }
+                Instruction& instr = instructions[candidate.index];
+                if (instr.size == 2) {
+                    candidate.limit = totalSize;  // comprimido: a compressão decide primeiro
+                    continue;
+                }
+                revisited++;
+                int64_t offset = 0;
+                if (!relaxableOffset(instr, offset)) {
+                    candidate.limit = UINT64_MAX;  // o erro aparece ao codificar
+                    continue;
+                }
+                bool conditional = opcodeTable[instr.opcode].type == B_TYPE;
+                uint32_t needed = relaxedSize(conditional, offset);
+                if (needed > instr.size) {
+                    relaxed += instr.size == 4 ? 1 : 0;
+                    instr.size = needed;
+                    widened++;
+                    candidate.limit = totalSize;  // o offset muda com o próprio crescimento
+                } else {
+                    uint64_t slack = relaxationSlack(conditional, instr.size, offset);
+                    candidate.limit = slack == UINT64_MAX ? UINT64_MAX : totalSize + slack + 1;
+                }
+            }
+            if (debugMode && !candidates.empty()) {
+                std::cout << "Layout, rodada " << round << ": " << revisited << " de " << candidates.size()
+                          << " desvios reavaliados, " << widened << " relaxados" << std::endl;
+            }
+            
+            if (grown == 0 && !reshaped && widened == 0) {
+                if (relaxed > 0 && !quietMode) {
+                    std::cout << "Relaxamento de desvios: " << relaxed << " desvio(s) fora do alcance em forma longa ("
+                              << round << " rodada(s) de layout)" << std::endl;
+                }
+                dropOmitted();
+                return true;
+            }
+        }
+    }
+    
+    // Percorre as linhas de data[0, size) pelas marcas '\n' do índice estrutural,
+    // entregando cada linha já analisada por parseLine
+    template <typename Function>
+    void forEachLine(const char* data, size_t size, const std::vector<uint32_t>& marks, Function handle) {
+        size_t next = 0;      // início da próxima linha
+        size_t nextMark = 0;  // primeira marca da próxima linha
+        while (next < size) {
+            size_t begin = next;
+            size_t firstMark = nextMark;
+            while (nextMark < marks.size() && data[marks[nextMark]] != '\n') {
+                nextMark++;
+            }
+            size_t end = nextMark < marks.size() ? marks[nextMark] : size;
+            next = end + 1;
+            
+            Instruction instr = parseLine(data, begin, end, marks.data() + firstMark, nextMark - firstMark);
+            if (nextMark < marks.size()) {
+                nextMark++;  // o próprio '\n'
+            }
+            handle(instr);
+        }
+    }
+    
+    // Nomes, na tabela de símbolos, do rótulo definido pela linha e do operando
+    // simbólico ("" quando não há). Rótulos locais numéricos ("1:") podem se
+    // repetir; a k-ésima definição de N vira o símbolo "N@k", e "Nb" e "Nf" são
+    // resolvidos aqui mesmo, na ordem do fonte. Em li/la, o operando simbólico
+    // é o valor.
+    void symbolNames(const Instruction& instr, std::unordered_map<std::string, int>& localDefinitions,
+                     std::string& label, std::string& operand) const {
+        label.clear();
+        operand.clear();
+        if (!instr.label.empty()) {
+            label = instr.label;
+            if (isLocalLabel(label)) {
+                label += "@" + std::to_string(localDefinitions[instr.label]++);
+            }
+        }
+        
+        bool constantLoad = instr.opcode == "li" || instr.opcode == "la";
+        int index = constantLoad ? (instr.operands.size() == 2 ? 1 : -1) : symbolOperandIndex(instr);
+        if (index < 0) {
+            return;
+        }
+        const std::string& text = instr.operands[index];
+        if (isLocalLabelReference(text)) {
+            std::string number = text.substr(0, text.size() - 1);
+            auto defined = localDefinitions.find(number);
+            int occurrence = (defined != localDefinitions.end() ? defined->second : 0) - (text.back() == 'b' ? 1 : 0);
+            // Sem definição anterior, "Nb" fica como símbolo inexistente
+            operand = occurrence >= 0 ? number + "@" + std::to_string(occurrence) : text;
+        } else if (!text.empty() && !std::isdigit(static_cast<unsigned char>(text[0])) &&
+                   std::strchr("-+~%('", text[0]) == nullptr) {
+            operand = text;
+        }
+    }
+    
+    // "li/la rd, Nb" ou "Nf": o valor passa a ser o símbolo "N@k" resolvido por
+    // symbolNames, antes da expansão. "Nb" sem definição anterior é erro aqui.
+    bool resolveLocalLoad(Instruction& instr, const std::string& symbolName) {
+        if (instr.operands.size() != 2 || !isLocalLabelReference(instr.operands[1])) {
+            return true;
+        }
+        if (symbolName == instr.operands[1]) {
+            reportError(instr, "Rótulo não encontrado '" + symbolName + "'");
+            return false;
+        }
+        instr.operands[1] = symbolName;
+        return true;
+    }
+    
+    // Endereço de ".org": numérico, múltiplo de 4 e a partir de minimum (o
+    // alvo do .org anterior)
+    bool parseOrigin(const Instruction& instr, int64_t minimum, uint32_t& address) {
+        int64_t target = 0;
+        ImmediateParser parser(symbolTable);
+        if (instr.operands.size() != 1) {
+            reportError(instr, ".org espera um único endereço");
+            return false;
+        }
+        if (!parser.evaluate(instr.operands[0], target) || parser.usedSymbol()) {
+            reportError(instr, ".org espera um endereço numérico: '" + instr.operands[0] + "'");
+            return false;
+        }
+        if (target < minimum || target % 4 != 0 || target > 0xFFFFFFFCLL) {
+            std::ostringstream message;
+            message << ".org 0x" << std::hex << target << " inválido (esperado múltiplo de 4, a partir de 0x"
+                    << minimum << ")";
+            reportError(instr, message.str());
+            return false;
+        }
+        address = static_cast<uint32_t>(target);
+        return true;
+    }
+    
+    bool firstPass() {
+        std::ifstream file(inputFile);
+        if (!file.is_open()) {
+            *errors << "Erro: Não foi possível abrir o arquivo de entrada: " << inputFile << std::endl;
+            return false;
+        }
+        
+        return firstPass(file);
+    }
+    
+    // Primeira passagem sobre um fluxo qualquer (arquivo ou texto em memória).
+    // O texto é lido inteiro e indexado pela varredura estrutural; o lexer
+    // percorre as linhas pelas marcas de '\n' do índice.
+    bool firstPass(std::istream& source) {
+        std::string text;
+        readAll(source, text);
+        if (text.size() > StructuralScanner::MAX_INPUT_SIZE) {
+            *errors << "Erro: Arquivo de entrada maior que 4 GiB: " << inputFile << std::endl;
+            return false;
+        }
+        
+        std::vector<uint32_t> marks;
+        StructuralScanner::scan(text.data(), text.size(), marks);
+        if (debugMode) {
+            std::cout << "Varredura estrutural (" << StructuralScanner::kernelName() << "): "
+                      << marks.size() << " marcas em " << text.size() << " bytes" << std::endl;
+        }
+        
+        std::vector<std::pair<uint32_t, size_t>> labels;  // ID do rótulo -> índice da próxima instrução
+        std::vector<Origin> origins;                      // diretivas .org, em ordem
+        uint64_t location = 0;                            // endereços provisórios, 4 bytes por instrução
+        bool valid = true;
+        int lineNumber = 0;
+        std::unordered_map<std::string, int> localDefinitions;
+        std::string labelName;
+        std::string symbolName;
+        std::vector<Instruction> loads;  // expansão de li/la
+        
+        forEachLine(text.data(), text.size(), marks, [&](Instruction& instr) {
+            instr.line = ++lineNumber;
+            symbolNames(instr, localDefinitions, labelName, symbolName);
+            
+            // Se a instrução tiver um rótulo, ele aponta para a próxima instrução
+            if (!labelName.empty()) {
+                labels.push_back({symbolTable.intern(labelName), instructions.size()});
+            }
+            
+            if (instr.opcode.empty()) {
+                return;
+            }
+            
+            // ".org endereço": as instruções seguintes começam no endereço dado.
+            // Rótulos entre a última instrução e o .org já marcam o novo endereço.
+            if (instr.opcode == ".org") {
+                uint32_t target = 0;
+                if (!parseOrigin(instr, origins.empty() ? 0 : origins.back().address, target)) {
+                    valid = false;
+                } else {
+                    origins.push_back({instructions.size(), target, instr.line});
+                    location = target;
+                }
+                return;
+            }
+            
+            if (instr.opcode == "li" || instr.opcode == "la") {
+                bool pending = false;
+                if (!resolveLocalLoad(instr, symbolName) || !expandConstantLoad(instr, loads, pending)) {
+                    valid = false;
+                    return;
+                }
+                for (Instruction& part : loads) {
+                    if (part.constant.empty() && compressionEnabled && isCompressionCandidate(part)) {
+                        part.size = 2;
+                    }
+                    part.address = static_cast<uint32_t>(location);
+                    location += part.size == 0 ? 0 : 4;
+                    instructions.push_back(std::move(part));
+                }
+                return;
+            }
+            instr.address = static_cast<uint32_t>(location);
+            location += 4;
+            if (compressionEnabled && !instr.forceCompressed && isCompressionCandidate(instr)) {
+                instr.size = 2;  // otimista; layoutInstructions aumenta o que não couber
+            }
+            
+            // Operando simbólico: internado uma única vez, as passagens seguintes usam o ID
+            if (!symbolName.empty()) {
+                instr.symbol = static_cast<int>(symbolTable.intern(symbolName));
+            }
+            instructions.push_back(std::move(instr));
+        });
+        
+        if (cfgOptimization && valid) {
+            optimizeControlFlow(labels, origins);
+        }
+        if (profileLayout && valid) {
+            layoutByProfile(labels, origins);
+        }
+        
+        // Reordenação opcional, sobre os endereços provisórios; rótulos e
+        // lacunas de .org delimitam os blocos
+        if (scheduleEnabled && valid) {
+            scheduleInstructions(labels);
+        }
+        
+        return valid && layoutInstructions(labels, origins);
+    }
+    
+    // Monta a imagem de memória; sem arquivo de saída, ela fica apenas em image
+    bool secondPass() {
+        image.clear();
+        
+        for (size_t i = 0; i < instructions.size(); i++) {
+            Instruction& instr = instructions[i];
+            
+            if (debugMode) {
+                std::cout << "Instrução #" << i << " (Endereço: 0x" << std::hex << instr.address << std::dec << ")" << std::endl;
+                instr.print();
+            }
+            
+            if (instr.opcode.empty()) {
+                if (debugMode) {
+                    std::cout << "  (Instrução vazia, pulando)" << std::endl;
+                }
+                continue;
+            }
+            
+            if (instr.size > 4) {
+                if (!appendRelaxed(instr)) {
+                    return false;
+                }
+                continue;
+            }
+            
+            std::string binary = encodeToBinary(instr);
+            if (!binary.empty() && instr.size == 2) {
+                uint16_t half = 0;
+                if (!CompressedCodec::compress(static_cast<uint32_t>(std::stoul(binary, nullptr, 2)), half)) {
+                    reportError(instr, "Instrução sem forma comprimida: c." + instr.toString());
+                    return false;
+                }
+                image.appendHalfword(instr.address, half);
+                if (debugMode) {
+                    std::cout << "  Código binário: " << binary << std::endl;
+                    std::cout << "  Forma comprimida: " << std::bitset<16>(half).to_string() << std::endl;
+                    std::cout << std::endl;
+                }
+            } else if (!binary.empty()) {
+                image.append(instr.address, static_cast<uint32_t>(std::stoul(binary, nullptr, 2)));
+                std::vector<std::string> binaryBytes = binaryToLittleEndianBinary(binary);
+                if (!binaryBytes.empty()) {
+                    if (debugMode) {
+                        std::cout << "  Código binário: " << binary << std::endl;
+                        std::cout << "  Bytes (little-endian):" << std::endl;
+                        for (size_t j = 0; j < binaryBytes.size(); j++) {
+                            std::cout << "    Byte " << j << ": " << binaryBytes[j] << std::endl;
+                        }
+                        std::cout << std::endl;
+                    }
+                } else {
+                    *errors << "Erro: Falha ao converter instrução para formato little-endian: " << instr.opcode << std::endl;
+                    return false;
+                }
+            } else {
+                *errors << "Erro: Falha ao codificar instrução: " << instr.opcode << std::endl;
+                return false;
+            }
+        }
+        
+        return writeOutput(false);
+    }
+    
+    // Codifica as partes de um desvio relaxado, em sequência na imagem
+    bool appendRelaxed(const Instruction& instr) {
+        std::vector<Instruction> parts;
+        if (!expandRelaxed(instr, parts)) {
+            return false;
+        }
+        for (const Instruction& part : parts) {
+            std::string binary = encodeToBinary(part);
+            if (binary.empty()) {
+                *errors << "Erro: Falha ao codificar instrução: " << instr.opcode << std::endl;
+                return false;
+            }
+            image.append(part.address, static_cast<uint32_t>(std::stoul(binary, nullptr, 2)));
+            if (debugMode) {
+                std::cout << "  Parte relaxada: " << part.toString() << " -> " << binary << std::endl;
+            }
+        }
+        if (debugMode) {
+            std::cout << std::endl;
+        }
+        return true;
+    }
+    
+    // Grava a imagem no arquivo de saída, se houver; written indica que o
+    // pipeline já gravou o arquivo enquanto codificava
+    bool writeOutput(bool written) {
+        if (outputFile.empty()) {
+            return true;
+        }
+        if (!written && !image.write(outputFile, quartusOutput)) {
+            return false;
+        }
+        if (!quietMode) {
+            std::cout << "Montagem concluída com sucesso. Arquivo gerado: " << outputFile;
+            if (quartusOutput || !image.isDense()) {
+                std::cout << " (formato Quartus, " << image.getSegments().size() << " trecho(s))";
+            }
+            std::cout << std::endl;
+        }
+        return true;
+    }
+    
+    // Codifica uma instrução na palavra final (16 bits quando size == 2)
+    bool encodeInstruction(const Instruction& instr, uint32_t& word) {
+        std::string binary = encodeToBinary(instr);
+        if (binary.empty()) {
+            *errors << "Erro: Falha ao codificar instrução: " << instr.opcode << std::endl;
+            return false;
+        }
+        word = static_cast<uint32_t>(std::stoul(binary, nullptr, 2));
+        if (instr.size == 2) {
+            uint16_t half = 0;
+            if (!CompressedCodec::compress(word, half)) {
+                reportError(instr, "Instrução sem forma comprimida: c." + instr.toString());
+                return false;
+            }
+            word = half;
+        }
+        return true;
+    }
+    
+    // Estado do estágio de codificação do pipeline (assemblePipelined)
+    struct StreamState {
+        uint64_t location = 0;
+        int64_t lastOrigin = 0;
+        std::vector<uint32_t> pendingLabels;                        // rótulos à espera da próxima instrução
+        std::unordered_map<uint32_t, std::vector<size_t>> waiting;  // símbolo -> instruções que o usam adiante
+        std::set<size_t> deferred;                                  // instruções ainda com palavra provisória
+        std::vector<std::pair<size_t, std::string>> syntaxErrors;   // por índice, impressos em ordem no fim
+        size_t encodeErrorIndex = SIZE_MAX;
+        std::string encodeError;
+        std::string layoutError;
+        bool firstPassFailed = false;
+        bool redefined = false;
+        bool relayout = false;                                      // li/la com rótulo ou desvio fora do alcance
+        std::vector<std::pair<uint32_t, size_t>> labels;            // para refazer o layout, se preciso
+        std::vector<Origin> origins;
+        std::vector<Instruction> loads;
+        std::ostringstream diagnostics;
+    };
+    
+    // Linha analisada pelo lexer do pipeline. Os nomes dos símbolos já vêm
+    // resolvidos: só o estágio de codificação mexe na tabela de símbolos.
+    struct LexedLine {
+        Instruction instr;
+        std::string labelName;
+        std::string symbolName;
+    };
+    
+    static const size_t PIPELINE_MIN_INPUT = 1 << 20;  // abaixo disso, criar threads custa mais que montar
+    static const size_t READ_BLOCK = 1 << 20;
+    static const size_t LINE_BATCH = 4096;
+    static const size_t WRITE_CHUNK = 1 << 14;         // palavras por bloco enviado à escrita
+    
+    // Valida e codifica a instrução index com os rótulos definidos até aqui.
+    // Uma referência adiante deixa a palavra provisória (zero) na imagem até a
+    // definição do rótulo; com final, o símbolo que falta é um erro de verdade.
+    // Os diagnósticos são guardados e impressos no fim, na ordem da montagem
+    // sequencial.
+    void encodeStreamed(size_t index, bool final, StreamState& state) {
+        const Instruction& instr = instructions[index];
+        std::ostream* previous = errors;
+        state.diagnostics.str("");
+        errors = &state.diagnostics;
+        unresolvedSymbol.clear();
+        bool valid = validateInstruction(instr);
+        uint32_t word = 0;
+        bool encoded = valid && encodeInstruction(instr, word);
+        errors = previous;
+        
+        if (encoded) {
+            image.patch(instr.address, word, instr.size);
+        } else if (!final && !unresolvedSymbol.empty()) {
+            state.waiting[symbolTable.intern(unresolvedSymbol)].push_back(index);
+            state.deferred.insert(index);
+        } else if (valid && needsRelaxation(instr)) {
+            state.relayout = true;  // desvio fora do alcance: o layout completo o relaxa
+        } else if (!valid) {
+            state.syntaxErrors.push_back({index, state.diagnostics.str()});
+        } else if (index < state.encodeErrorIndex) {
+            state.encodeErrorIndex = index;
+            state.encodeError = state.diagnostics.str();
+        }
+    }
+    
+    // Define um rótulo e codifica as instruções que esperavam por ele
+    void defineStreamed(uint32_t id, uint32_t address, StreamState& state) {
+        int previous = 0;
+        if (symbolTable.lookup(id, previous)) {
+            // Vale a última definição, como na montagem sequencial; as
+            // referências já codificadas são refeitas no fim
+            state.redefined = true;
+        }
+        symbolTable.define(id, static_cast<int>(address));
+        
+        auto it = state.waiting.find(id);
+        if (it == state.waiting.end()) {
+            return;
+        }
+        std::vector<size_t> indices = std::move(it->second);
+        state.waiting.erase(it);
+        for (size_t index : indices) {
+            state.deferred.erase(index);
+            encodeStreamed(index, false, state);
+        }
+    }
+    
+    // Estágio de codificação: endereços, rótulos, .org e palavras de uma linha.
+    // Sem compressão nem escalonamento, o endereço de cada instrução já é o
+    // final assim que ela chega; um li/la com rótulo ainda sem valor e um
+    // desvio que precisa ser relaxado são as exceções, e pedem um layout
+    // completo no fim.
+    void streamLine(LexedLine& line, StreamState& state) {
+        Instruction& instr = line.instr;
+        if (!line.labelName.empty()) {
+            uint32_t id = symbolTable.intern(line.labelName);
+            state.pendingLabels.push_back(id);
+            state.labels.push_back({id, instructions.size()});
+        }
+        if (instr.opcode.empty()) {
+            return;
+        }
+        
+        if (instr.opcode == ".org") {
+            uint32_t target = 0;
+            if (!parseOrigin(instr, state.lastOrigin, target)) {
+                state.firstPassFailed = true;
+                return;
+            }
+            state.lastOrigin = target;
+            state.origins.push_back({instructions.size(), target, instr.line});
+            if (state.location > target && !state.firstPassFailed && state.layoutError.empty()) {
+                std::ostringstream message;
+                message << "Erro na linha " << instr.line << ": .org 0x" << std::hex << target
+                        << " fica antes do fim do código anterior (0x" << state.location << ")";
+                state.layoutError = message.str();
+            }
+            state.location = target;
+            return;
+        }
+        
+        if (instr.opcode == "li" || instr.opcode == "la") {
+            bool pending = false;
+            if (!resolveLocalLoad(instr, line.symbolName) || !expandConstantLoad(instr, state.loads, pending)) {
+                state.firstPassFailed = true;
+                return;
+            }
+            state.relayout = state.relayout || pending;
+            for (Instruction& part : state.loads) {
+                streamInstruction(part, "", state);
+            }
+            return;
+        }
+        streamInstruction(instr, line.symbolName, state);
+    }
+    
+    void streamInstruction(Instruction& instr, const std::string& symbolName, StreamState& state) {
+        bool failed = state.firstPassFailed || !state.layoutError.empty();
+        if (state.location + instr.size > 0x100000000ULL && !failed) {
+            state.layoutError = "Erro na linha " + std::to_string(instr.line) +
+                                ": Instrução além do fim do espaço de endereçamento";
+            failed = true;
+        }
+        
+        instr.address = static_cast<uint32_t>(state.location);
+        state.location += instr.size;
+        for (uint32_t id : state.pendingLabels) {
+            defineStreamed(id, instr.address, state);
+        }
+        state.pendingLabels.clear();
+        
+        if (!symbolName.empty()) {
+            instr.symbol = static_cast<int>(symbolTable.intern(symbolName));
+        }
+        if (instr.size == 2) {
+            image.appendHalfword(instr.address, 0);
+        } else if (instr.size == 4) {
+            image.append(instr.address, 0);
+        }
+        instructions.push_back(std::move(instr));
+        if (!failed && instructions.back().size != 0) {
+            encodeStreamed(instructions.size() - 1, false, state);
+        }
+    }
+    
+    // Montagem em pipeline para entradas grandes: leitura em blocos, lexer,
+    // codificação e escrita rodam ao mesmo tempo, ligados por filas limitadas.
+    // As referências adiante são corrigidas na imagem antes que a escrita
+    // receba as palavras: só seguem para o arquivo as palavras anteriores à
+    // primeira instrução ainda à espera de um rótulo. O arquivo é gravado com
+    // outro nome e renomeado no fim, para que uma montagem com erro não deixe
+    // saída parcial.
+    bool assemblePipelined(std::istream& source) {
+        BoundedQueue<std::string> blocks(8);
+        BoundedQueue<std::vector<LexedLine>> batches(16);
+        BoundedQueue<std::vector<uint32_t>> chunks(16);
+        
+        std::thread reader([&]() {
+            for (;;) {
+                std::string block(READ_BLOCK, '\0');
+                source.read(&block[0], static_cast<std::streamsize>(block.size()));
+                block.resize(static_cast<size_t>(source.gcount()));
+                bool last = block.empty();
+                blocks.push(std::move(block));
+                if (last) {
+                    return;
+                }
+            }
+        });
+        
+        // O lexer só analisa linhas completas; o resto do bloco espera o próximo
+        std::thread lexer([&]() {
+            std::string buffer;
+            std::vector<uint32_t> marks;
+            std::vector<LexedLine> batch;
+            std::unordered_map<std::string, int> localDefinitions;
+            int lineNumber = 0;
+            for (bool done = false; !done;) {
+                std::string block = blocks.pop();
+                done = block.empty();
+                buffer += block;
+                size_t limit = done ? buffer.size() : buffer.rfind('\n') + 1;
+                if (limit == 0) {
+                    continue;  // linha maior que o bloco (ou npos + 1)
+                }
+                
+                StructuralScanner::scan(buffer.data(), limit, marks);
+                forEachLine(buffer.data(), limit, marks, [&](Instruction& instr) {
+                    instr.line = ++lineNumber;
+                    batch.emplace_back();
+                    LexedLine& line = batch.back();
+                    symbolNames(instr, localDefinitions, line.labelName, line.symbolName);
+                    line.instr = std::move(instr);
+                    if (batch.size() == LINE_BATCH) {
+                        batches.push(std::move(batch));
+                        batch.clear();
+                    }
+                });
+                buffer.erase(0, limit);
+            }
+            if (!batch.empty()) {
+                batches.push(std::move(batch));
+            }
+            batches.push(std::vector<LexedLine>());
+        });
+        
+        // Escrita no formato de bytes, enquanto a imagem continuar densa
+        bool streaming = !outputFile.empty() && !quartusOutput;
+        std::string partialPath = outputFile + ".parcial";
+        std::atomic<bool> streamAborted(false);
+        bool written = false;
+        std::thread writer;
+        if (streaming) {
+            writer = std::thread([&]() {
+                char table[256][9];
+                for (int value = 0; value < 256; value++) {
+                    for (int bit = 0; bit < 8; bit++) {
+                        table[value][bit] = ((value >> (7 - bit)) & 1) ? '1' : '0';
+                    }
+                    table[value][8] = '\n';
+                }
+                std::FILE* file = std::fopen(partialPath.c_str(), "wb");
+                bool ok = file != nullptr;
+                std::string text;
+                for (;;) {
+                    std::vector<uint32_t> words = chunks.pop();
+                    if (words.empty()) {
+                        break;
+                    }
+                    if (!ok || streamAborted) {
+                        continue;
+                    }
+                    text.resize(words.size() * 36);
+                    char* out = &text[0];
+                    for (uint32_t word : words) {
+                        for (int byte = 0; byte < 4; byte++, out += 9) {
+                            std::memcpy(out, table[(word >> (byte * 8)) & 0xFF], 9);
+                        }
+                    }
+                    ok = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+                }
+                if (file != nullptr && std::fclose(file) != 0) {
+                    ok = false;
+                }
+                written = ok;
+            });
+        }
+        
+        // Estágio de codificação, nesta thread (dona da tabela de símbolos e da imagem)
+        StreamState state;
+        size_t sentWords = 0;
+        auto sendWords = [&](bool all) {
+            if (image.empty()) {
+                return;
+            }
+            const std::vector<uint32_t>& words = image.getSegments().begin()->second;
+            uint64_t ready = state.deferred.empty() ? state.location : instructions[*state.deferred.begin()].address;
+            size_t end = all ? words.size() : static_cast<size_t>(ready / 4);
+            if (end > sentWords && (all || end - sentWords >= WRITE_CHUNK)) {
+                chunks.push(std::vector<uint32_t>(words.begin() + sentWords, words.begin() + end));
+                sentWords = end;
+            }
+        };
+        
+        for (;;) {
+            std::vector<LexedLine> batch = batches.pop();
+            if (batch.empty()) {
+                break;
+            }
+            for (LexedLine& line : batch) {
+                streamLine(line, state);
+            }
+            if (streaming && !streamAborted) {
+                if (state.firstPassFailed || !state.layoutError.empty() || state.redefined || state.relayout ||
+                    !image.isDense()) {
+                    streamAborted = true;
+                } else {
+                    sendWords(false);
+                }
+            }
+        }
+        for (uint32_t id : state.pendingLabels) {
+            defineStreamed(id, static_cast<uint32_t>(state.location), state);
+        }
+        reader.join();
+        lexer.join();
+        
+        bool success = false;
+        if (state.firstPassFailed) {
+            // erros já impressos pelo .org
+        } else if (!state.layoutError.empty()) {
+            *errors << state.layoutError << std::endl;
+        } else {
+            if (!quietMode) {
+                std::cout << "Leitura e análise concluídas. Símbolos encontrados: " << symbolTable.size() << std::endl;
+            }
+            std::vector<size_t> remaining(state.deferred.begin(), state.deferred.end());
+            state.deferred.clear();
+            state.waiting.clear();
+            bool redo = state.redefined || state.relayout;
+            if (!redo) {
+                for (size_t index : remaining) {
+                    encodeStreamed(index, true, state);
+                }
+            }
+            
+            if (redo) {
+                success = true;  // refeito abaixo, depois de encerrar a escrita
+            } else if (!state.syntaxErrors.empty()) {
+                std::stable_sort(state.syntaxErrors.begin(), state.syntaxErrors.end(),
+                                 [](const std::pair<size_t, std::string>& a, const std::pair<size_t, std::string>& b) {
+                                     return a.first < b.first;
+                                 });
+                for (const auto& error : state.syntaxErrors) {
+                    *errors << error.second;
+                }
+                *errors << "Erros de sintaxe encontrados. Abortando." << std::endl;
+            } else if (!state.encodeError.empty()) {
+                *errors << state.encodeError;
+            } else {
+                success = true;
+            }
+        }
+        
+        bool streamed = false;
+        if (streaming) {
+            if (success && !state.redefined && !state.relayout && !streamAborted && image.isDense()) {
+                sendWords(true);
+            } else {
+                streamAborted = true;
+            }
+            chunks.push(std::vector<uint32_t>());
+            writer.join();
+            streamed = written && !streamAborted && std::rename(partialPath.c_str(), outputFile.c_str()) == 0;
+            if (!streamed) {
+                std::remove(partialPath.c_str());
+            }
+        }
+        
+        // Um rótulo definido duas vezes muda referências já codificadas, e um
+        // li/la com rótulo adiante ou um desvio relaxado muda de tamanho:
+        // layout, validação e codificação são refeitos sobre as instruções
+        // já analisadas
+        if (success && (state.redefined || state.relayout)) {
+            if (!layoutInstructions(state.labels, state.origins)) {
+                return false;
+            }
+            if (!validateSyntax()) {
+                *errors << "Erros de sintaxe encontrados. Abortando." << std::endl;
+                return false;
+            }
+            return secondPass();
+        }
+        dropOmitted();
+        return success && writeOutput(streamed);
+    }
+    
+    // Função principal para executar o montador
+    bool assemble() {
+        std::ifstream file(inputFile);
+        if (!file.is_open()) {
+            *errors << "Erro: Não foi possível abrir o arquivo de entrada: " << inputFile << std::endl;
+            return false;
+        }
+        
+        return assemble(file);
+    }
+    
+    // Monta o código lido de um fluxo; usado também para montar texto em memória
+    bool assemble(std::istream& source) {
+        // As tabelas fixas são montadas uma única vez por instância; o estado
+        // do programa anterior é descartado, para que a instância possa ser reutilizada
+        if (opcodeTable.empty()) {
+            initRegisterTable();
+            initOpcodeTable();
+        }
+        instructions.clear();
+        symbolTable = SymbolTable();
+        image.clear();
+        
+        // Entradas grandes sem reordenação nem compressão (que precisam do
+        // programa inteiro antes de fixar endereços) seguem pelo pipeline
+        if (!scheduleEnabled && !compressionEnabled && !cfgOptimization && !profileLayout && !debugMode) {
+            int64_t size = remainingSize(source);
+            if (size < 0 || static_cast<uint64_t>(size) >= PIPELINE_MIN_INPUT) {
+                if (!quietMode) {
+                    std::cout << "Iniciando a montagem em pipeline (leitura, análise, codificação e escrita simultâneas)..."
+                              << std::endl;
+                }
+                return assemblePipelined(source);
+            }
+        }
+        
+        if (!quietMode) {
+            std::cout << "Iniciando a primeira passagem..." << std::endl;
+        }
+        if (!firstPass(source)) {
+            return false;
+        }
+        
+        if (!quietMode) {
+            std::cout << "Primeira passagem concluída. Símbolos encontrados: " << symbolTable.size() << std::endl;
+        }
+        
+        if (debugMode) {
+            std::cout << "Tabela de símbolos:" << std::endl;
+            symbolTable.forEach([](const std::string& name, int value) {
+                std::cout << "  " << name << " = 0x" << std::hex << value << std::dec << std::endl;
+            });
+        }
+        
+        if (!quietMode) {
+            std::cout << "Validando sintaxe..." << std::endl;
+        }
+        if (!validateSyntax()) {
+            *errors << "Erros de sintaxe encontrados. Abortando." << std::endl;
+            return false;
+        }
+        
+        if (!quietMode) {
+            std::cout << "Sintaxe válida. Iniciando a segunda passagem..." << std::endl;
+        }
+        
+        if (!secondPass()) {
+            return false;
+        }
+        
+        return true;
+    }
+    
+    // Modo --check: análise léxica, coleta de rótulos e validação de sintaxe,
+    // sem layout, codificação nem arquivo de saída. Trechos iguais aos de uma
+    // verificação anterior vêm do cache; só a resolução de rótulos e .org,
+    // que depende do arquivo inteiro, é refeita. Diagnósticos em ordem de linha.
+    std::vector<Diagnostic> check(const std::string& source) {
+        if (opcodeTable.empty()) {
+            initRegisterTable();
+            initOpcodeTable();
+        }
+        if (!checkCache) {
+            checkCache = std::make_shared<CheckCache>();
+        }
+        symbolTable = SymbolTable();  // li/la com rótulo ficam pendentes, como na primeira passagem
+        std::ostream* savedErrors = errors;
+        std::ostream discard(nullptr);
+        errors = &discard;  // getRegisterNumber também escreve; valem só os diagnósticos
+        
+        uint64_t use = checkCache->begin();
+        struct Piece {
+            size_t begin;
+            size_t end;
+            uint64_t hash;
+        };
+        std::vector<Piece> pieces;
+        std::vector<std::shared_ptr<const CheckChunk>> chunks;
+        const char* data = source.data();
+        size_t size = source.size();
+        size_t chunkStart = 0;
+        int lines = 0;
+        uint64_t chunkHash = 0;
+        for (size_t pos = 0; pos < size;) {
+            const char* newline = static_cast<const char*>(std::memchr(data + pos, '\n', size - pos));
+            size_t end = newline ? static_cast<size_t>(newline - data) + 1 : size;
+            uint64_t lineHash = hashBytes(data + pos, end - pos);
+            chunkHash = ((chunkHash << 5 | chunkHash >> 59) ^ lineHash) * 0x9E3779B97F4A7C15ULL;
+            lines++;
+            pos = end;
+            if ((lines >= CHECK_CHUNK_MIN && (lineHash & CHECK_CHUNK_MASK) == 0) || lines == CHECK_CHUNK_MAX ||
+                pos == size) {
+                pieces.push_back({chunkStart, pos, chunkHash});
+                chunks.push_back(checkCache->find(chunkHash, data + chunkStart, pos - chunkStart, use));
+                chunkStart = pos;
+                lines = 0;
+                chunkHash = 0;
+            }
+        }
+        
+        // Trechos novos: uma varredura estrutural por sequência de trechos
+        // ausentes do cache, repartida entre eles
+        std::vector<uint32_t> marks;
+        std::vector<uint32_t> chunkMarks;
+        for (size_t first = 0; first < chunks.size(); first++) {
+            if (chunks[first]) {
+                continue;
+            }
+            size_t last = first;
+            while (last + 1 < chunks.size() && !chunks[last + 1]) {
+                last++;
+            }
+            size_t runBegin = pieces[first].begin;
+            StructuralScanner::scan(data + runBegin, pieces[last].end - runBegin, marks);
+            size_t mark = 0;
+            for (size_t k = first; k <= last; k++) {
+                uint32_t offset = static_cast<uint32_t>(pieces[k].begin - runBegin);
+                uint32_t limit = static_cast<uint32_t>(pieces[k].end - runBegin);
+                chunkMarks.clear();
+                for (; mark < marks.size() && marks[mark] < limit; mark++) {
+                    chunkMarks.push_back(marks[mark] - offset);
+                }
+                chunks[k] = analyzeChunk(data + pieces[k].begin, pieces[k].end - pieces[k].begin, chunkMarks);
+                checkCache->insert(pieces[k].hash, chunks[k], use);
+            }
+            first = last;
+        }
+        checkCache->trim(chunks.size(), use);
+        
+        // Destinos só precisam existir: todo rótulo vale 0
+        SymbolTable labels;
+        std::unordered_map<std::string, int> localTotal;
+        for (const auto& chunk : chunks) {
+            for (const std::string& name : chunk->labels) {
+                labels.define(name, 0);
+            }
+            for (const CheckChunk::Event& event : chunk->events) {
+                if (event.kind == CheckChunk::LOCAL_DEFINITION) {
+                    localTotal[event.text]++;
+                }
+            }
+        }
+        
+        std::vector<Diagnostic> result;
+        std::vector<PendingDiagnostic> pending;
+        std::unordered_map<std::string, int> localSeen;
+        int64_t minimumOrigin = 0;
+        int base = 0;
+        for (const auto& chunk : chunks) {
+            for (const Diagnostic& diagnostic : chunk->diagnostics) {
+                result.push_back({base + diagnostic.line, diagnostic.column, diagnostic.message});
+            }
+            size_t origin = 0;
+            for (const CheckChunk::Event& event : chunk->events) {
+                int line = base + event.line;
+                switch (event.kind) {
+                    case CheckChunk::LOCAL_DEFINITION:
+                        localSeen[event.text]++;
+                        break;
+                    case CheckChunk::LOCAL_REFERENCE: {
+                        std::string number = event.text.substr(0, event.text.size() - 1);
+                        int seen = localSeen[number];
+                        if (event.text.back() == 'b' ? seen == 0 : localTotal[number] <= seen) {
+                            result.push_back({line, event.column, "Rótulo não encontrado '" + event.text + "'"});
+                        }
+                        break;
+                    }
+                    case CheckChunk::REFERENCE: {
+                        int address = 0;
+                        if (ImmediateParser::isSymbolName(event.text)) {
+                            if (!labels.lookup(event.text, address)) {
+                                result.push_back({line, event.column, "Rótulo não encontrado '" + event.text + "'"});
+                            }
+                            break;
+                        }
+                        int64_t value = 0;
+                        ImmediateParser parser(labels);
+                        if (!parser.evaluate(event.text, value)) {
+                            result.push_back({line, event.column, parser.getError()});
+                        }
+                        break;
+                    }
+                    case CheckChunk::ORIGIN: {
+                        Instruction instr = chunk->origins[origin++];
+                        instr.line = line;
+                        uint32_t target = 0;
+                        diagnosticSink = &pending;
+                        if (parseOrigin(instr, minimumOrigin, target)) {
+                            minimumOrigin = target;
+                        }
+                        diagnosticSink = nullptr;
+                        for (const PendingDiagnostic& diagnostic : pending) {
+                            result.push_back({line, event.column, diagnostic.message});
+                        }
+                        pending.clear();
+                        break;
+                    }
+                }
+            }
+            base += chunk->lines;
+        }
+        errors = savedErrors;
+        
+        std::stable_sort(result.begin(), result.end(), [](const Diagnostic& a, const Diagnostic& b) {
+            return a.line != b.line ? a.line < b.line : a.column < b.column;
+        });
+        return result;
+    }
+    
+    // Diagnósticos do --check em JSON, para editores:
+    // {"diagnosticos":[{"linha":L,"coluna":C,"mensagem":"..."}]}
+    static std::string diagnosticsJson(const std::vector<Diagnostic>& diagnostics) {
+        std::string json = "{\"diagnosticos\":[";
+        for (size_t i = 0; i < diagnostics.size(); i++) {
+            const Diagnostic& diagnostic = diagnostics[i];
+            json += i == 0 ? "{" : ",{";
+            json += "\"linha\":" + std::to_string(diagnostic.line) + ",\"coluna\":" + std::to_string(diagnostic.column) +
+                    ",\"mensagem\":\"";
+            for (char c : diagnostic.message) {
+                if (c == '"' || c == '\\') {
+                    json += '\\';
+                    json += c;
+                } else if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    json += escaped;
+                } else {
+                    json += c;
+                }
+            }
+            json += "\"}";
+        }
+        json += "]}";
+        return json;
+    }
+};
+
+// Simulador do conjunto de instruções (ISS) do myRV32I.
+// Cada palavra do programa é decodificada uma única vez para um vetor indexado
+// por PC/4; o laço principal apenas despacha sobre as instruções pré-decodificadas.
+class Simulator {
+public:
+    enum Operation : uint8_t {
+        OP_ADD, OP_SUB, OP_SLL, OP_SLT, OP_SLTU, OP_XOR, OP_SRL, OP_SRA, OP_OR, OP_AND,
+        OP_MUL, OP_MULH, OP_MULHSU, OP_MULHU, OP_DIV, OP_DIVU, OP_REM, OP_REMU,
+        OP_ADDI, OP_SLTI, OP_SLTIU, OP_XORI, OP_ORI, OP_ANDI, OP_SLLI, OP_SRLI, OP_SRAI,
+        OP_LB, OP_LH, OP_LW, OP_LBU, OP_LHU,
+        OP_SB, OP_SH, OP_SW,
+        OP_BEQ, OP_BNE, OP_BLT, OP_BGE, OP_BLTU, OP_BGEU,
+        OP_LUI, OP_AUIPC, OP_JAL, OP_JALR,
+        OP_INVALID
+    };
+    
+    enum StopReason {
+        STOP_END_OF_PROGRAM,
+        STOP_SELF_LOOP,
+        STOP_STEP_LIMIT,
+        STOP_INVALID_INSTRUCTION,
+        STOP_MEMORY_FAULT,
+        STOP_PC_OUT_OF_RANGE
+    };
+    
+    // Instrução pré-decodificada. Campos de registrador que o formato não lê
+    // ficam em zero, para que a detecção de load-use não precise do formato.
+    struct DecodedInstruction {
+        Operation op;
+        uint8_t rd;
+        uint8_t rs1;
+        uint8_t rs2;
+        int32_t imm;
+        uint8_t size = 4;  // 2 para instruções comprimidas
+    };
+    
+private:
+    PipelineModel model;
+    std::vector<uint8_t> memory;
+    std::vector<DecodedInstruction> decoded;
+    uint32_t regs[32];
+    uint32_t pc;
+    uint32_t codeBytes;
+    unsigned codeShift;               // decoded indexado por PC >> 2, ou PC >> 1 com instruções comprimidas
+    uint64_t instret;
+    uint64_t cycles;
+    double elapsedSeconds;
+    StopReason stopReason;
+    uint32_t faultAddress;
+    std::FILE* traceFile;             // Traço de PCs (uint32 little-endian), opcional
+    std::vector<uint32_t> traceBuffer;
+    
+    void flushTrace() {
+        if (traceFile && !traceBuffer.empty()) {
+            std::fwrite(traceBuffer.data(), sizeof(uint32_t), traceBuffer.size(), traceFile);
+            traceBuffer.clear();
+        }
+    }
+    
+    uint32_t readWord(uint32_t addr) const {
+        return static_cast<uint32_t>(memory[addr]) |
+               (static_cast<uint32_t>(memory[addr + 1]) << 8) |
+               (static_cast<uint32_t>(memory[addr + 2]) << 16) |
+               (static_cast<uint32_t>(memory[addr + 3]) << 24);
+    }
+    
+    void writeWord(uint32_t addr, uint32_t value) {
+        memory[addr] = static_cast<uint8_t>(value);
+        memory[addr + 1] = static_cast<uint8_t>(value >> 8);
+        memory[addr + 2] = static_cast<uint8_t>(value >> 16);
+        memory[addr + 3] = static_cast<uint8_t>(value >> 24);
+    }
+    
+    // Decodifica a instrução que começa em addr (de 16 ou 32 bits)
+    DecodedInstruction decodeAt(uint32_t addr) const {
+        uint16_t half = static_cast<uint16_t>(memory[addr] | (memory[addr + 1] << 8));
+        if ((half & 3) == 3) {
+            return addr + 4 <= memory.size() ? decode(readWord(addr)) : decode(0);
+        }
+        DecodedInstruction d = decode(CompressedCodec::expand(half));
+        d.size = 2;
+        return d;
+    }
+    
+    // Stores sobre a área de código invalidam a decodificação da palavra afetada
+    // (com instruções comprimidas, das duas posições que podem conter o byte)
+    void refreshDecoded(uint32_t addr) {
+        if (codeShift == 2) {
+            if (addr < codeBytes) {
+                decoded[addr >> 2] = decode(readWord(addr & ~3u));
+            }
+            return;
+        }
+        uint32_t position = addr & ~1u;
+        if (position < codeBytes) {
+            decoded[position >> 1] = decodeAt(position);
+        }
+        if (position >= 2 && position - 2 < codeBytes) {
+            decoded[(position - 2) >> 1] = decodeAt(position - 2);
+        }
+    }
+
+public:
+    Simulator(const PipelineModel& pipeline = PipelineModel(), size_t memorySize = 1 << 20)
+        : model(pipeline), memory(memorySize, 0), pc(0), codeBytes(0), codeShift(2), instret(0), cycles(0),
+          elapsedSeconds(0.0), stopReason(STOP_END_OF_PROGRAM), faultAddress(0), traceFile(nullptr) {
+        for (int i = 0; i < 32; i++) {
+            regs[i] = 0;
+        }
+    }
+    
+    // Decodifica uma palavra de 32 bits para o formato interno do simulador
+    static DecodedInstruction decode(uint32_t word) {
+        DecodedInstruction d = {OP_INVALID, 0, 0, 0, 0};
+        uint32_t opcode = word & 0x7F;
+        uint8_t rd = (word >> 7) & 0x1F;
+        uint32_t funct3 = (word >> 12) & 0x7;
+        uint8_t rs1 = (word >> 15) & 0x1F;
+        uint8_t rs2 = (word >> 20) & 0x1F;
+        uint32_t funct7 = word >> 25;
+        
+        int32_t immI = static_cast<int32_t>(word) >> 20;
+        int32_t immS = (static_cast<int32_t>(word & 0xFE000000) >> 20) | ((word >> 7) & 0x1F);
+        int32_t immB = (static_cast<int32_t>(word & 0x80000000) >> 19) | ((word & 0x80) << 4) |
+                       ((word >> 20) & 0x7E0) | ((word >> 7) & 0x1E);
+        int32_t immU = static_cast<int32_t>(word & 0xFFFFF000);
+        int32_t immJ = (static_cast<int32_t>(word & 0x80000000) >> 11) | (word & 0xFF000) |
+                       ((word >> 9) & 0x800) | ((word >> 20) & 0x7FE);
+        
+        switch (opcode) {
+            case 0x33: {  // Tipo R (base e extensão M)
+                static const Operation base[8] = {OP_ADD, OP_SLL, OP_SLT, OP_SLTU, OP_XOR, OP_SRL, OP_OR, OP_AND};
+                static const Operation mext[8] = {OP_MUL, OP_MULH, OP_MULHSU, OP_MULHU, OP_DIV, OP_DIVU, OP_REM, OP_REMU};
+                if (funct7 == 0x00) {
+                    d.op = base[funct3];
+                } else if (funct7 == 0x01) {
+                    d.op = mext[funct3];
+                } else if (funct7 == 0x20 && funct3 == 0) {
+                    d.op = OP_SUB;
+                } else if (funct7 == 0x20 && funct3 == 5) {
+                    d.op = OP_SRA;
+                } else {
+                    return d;
+                }
+                d = {d.op, rd, rs1, rs2, 0};
+                break;
+            }
+            case 0x13: {  // Tipo I aritméticas
+                static const Operation ops[8] = {OP_ADDI, OP_SLLI, OP_SLTI, OP_SLTIU, OP_XORI, OP_SRLI, OP_ORI, OP_ANDI};
+                Operation op = ops[funct3];
+                if (funct3 == 1 && funct7 != 0x00) {
+                    return d;
+                }
+                if (funct3 == 5) {
+                    if (funct7 == 0x20) {
+                        op = OP_SRAI;
+                    } else if (funct7 != 0x00) {
+                        return d;
+                    }
+                }
+                int32_t imm = (funct3 == 1 || funct3 == 5) ? static_cast<int32_t>(rs2) : immI;
+                d = {op, rd, rs1, 0, imm};
+                break;
+            }
+            case 0x03: {  // Loads
+                static const Operation ops[8] = {OP_LB, OP_LH, OP_LW, OP_INVALID, OP_LBU, OP_LHU, OP_INVALID, OP_INVALID};
+                if (ops[funct3] == OP_INVALID) {
+                    return d;
+                }
+                d = {ops[funct3], rd, rs1, 0, immI};
+                break;
+            }
+            case 0x23: {  // Stores
+                static const Operation ops[8] = {OP_SB, OP_SH, OP_SW, OP_INVALID, OP_INVALID, OP_INVALID, OP_INVALID, OP_INVALID};
+                if (ops[funct3] == OP_INVALID) {
+                    return d;
+                }
+                d = {ops[funct3], 0, rs1, rs2, immS};
+                break;
+            }
+            case 0x63: {  // Branches
+                static const Operation ops[8] = {OP_BEQ, OP_BNE, OP_INVALID, OP_INVALID, OP_BLT, OP_BGE, OP_BLTU, OP_BGEU};
+                if (ops[funct3] == OP_INVALID) {
+                    return d;
+                }
+                d = {ops[funct3], 0, rs1, rs2, immB};
+                break;
+            }
+            case 0x37:
+                d = {OP_LUI, rd, 0, 0, immU};
+                break;
+            case 0x17:
+                d = {OP_AUIPC, rd, 0, 0, immU};
+                break;
+            case 0x6F:
+                d = {OP_JAL, rd, 0, 0, immJ};
+                break;
+            case 0x67:
+                if (funct3 != 0) {
+                    return d;
+                }
+                d = {OP_JALR, rd, rs1, 0, immI};
+                break;
+            default:
+                break;
+        }
+        return d;
+    }
+    
+    // Grava o PC de cada instrução executada no arquivo (nullptr desativa)
+    void setTraceFile(std::FILE* file) {
+        traceFile = file;
+        traceBuffer.reserve(1 << 16);
+    }
+    
+    // Carrega cada trecho da imagem no seu endereço e pré-decodifica as palavras.
+    // A execução começa no trecho de menor endereço; lacunas decodificam como
+    // palavras nulas (instrução inválida). Se algum trecho tiver instruções
+    // comprimidas, toda posição de meia palavra é pré-decodificada.
+    bool load(const MemoryImage& image) {
+        if (image.endAddress() > memory.size()) {
+            std::cerr << "Erro: Programa não cabe na memória do simulador" << std::endl;
+            return false;
+        }
+        
+        codeBytes = static_cast<uint32_t>(image.endAddress());
+        codeShift = 2;
+        for (const auto& segment : image.getSegments()) {
+            const std::vector<uint32_t>& words = segment.second;
+            for (size_t i = 0; i < words.size(); i++) {
+                writeWord(segment.first + static_cast<uint32_t>(i * 4), words[i]);
+            }
+            // Percorre o fluxo de instruções do trecho procurando uma comprimida
+            uint64_t end = static_cast<uint64_t>(segment.first) + words.size() * 4;
+            for (uint64_t address = segment.first; address < end && codeShift == 2;) {
+                bool compressed = (memory[address] & 3) != 3;
+                codeShift = compressed ? 1 : 2;
+                address += compressed ? 2 : 4;
+            }
+        }
+        
+        // A meia palavra de enchimento depois de uma comprimida final não é código.
+        // Só é enchimento se uma instrução começa nela: o fluxo do último trecho
+        // é percorrido, já que 00 00 também pode ser o fim de uma de 32 bits.
+        if (codeShift == 1 && !image.getSegments().empty()) {
+            uint64_t address = image.getSegments().rbegin()->first;
+            while (address + 2 < codeBytes) {
+                address += (memory[address] & 3) != 3 ? 2 : 4;
+            }
+            if (address == codeBytes - 2 && memory[address] == 0 && memory[address + 1] == 0) {
+                codeBytes -= 2;
+            }
+        }
+        
+        decoded.assign(codeBytes >> codeShift, decode(0));
+        for (const auto& segment : image.getSegments()) {
+            uint64_t end = static_cast<uint64_t>(segment.first) + segment.second.size() * 4;
+            end = std::min<uint64_t>(end, codeBytes);
+            for (uint64_t address = segment.first; address < end; address += (1u << codeShift)) {
+                decoded[address >> codeShift] = (codeShift == 2) ? decode(readWord(static_cast<uint32_t>(address)))
+                                                                  : decodeAt(static_cast<uint32_t>(address));
+            }
+        }
+        
+        for (int i = 0; i < 32; i++) {
+            regs[i] = 0;
+        }
+        regs[2] = static_cast<uint32_t>(memory.size());  // sp no topo da memória
+        pc = image.startAddress();
+        instret = 0;
+        cycles = 0;
+        return true;
+    }
+    
+    // Executa até o fim do programa, um laço "j ." ou o limite de passos
+    StopReason run(uint64_t maxSteps) {
+        DecodedInstruction* code = decoded.data();
+        uint8_t* mem = memory.data();
+        const uint32_t memSize = static_cast<uint32_t>(memory.size());
+        uint32_t* x = regs;
+        uint32_t currentPc = pc;
+        uint64_t executed = 0;
+        bool running = true;
+        
+        // Ciclo de emissão da próxima instrução e ciclo a partir do qual cada
+        // registrador pode ser lido sem bolhas
+        uint64_t cycle = 0;
+        uint64_t ready[32] = {0};
+        const uint64_t aluLatency = 1 + model.resultLatency(false);
+        const uint64_t loadLatency = 1 + model.resultLatency(true);
+        const uint64_t branchPenalty = model.branchPenalty;
+        const uint64_t jumpPenalty = model.jumpPenalty;
+        const unsigned shift = codeShift;
+        const uint32_t alignMask = (1u << shift) - 1;
+        
+        stopReason = STOP_STEP_LIMIT;
+        auto start = std::chrono::steady_clock::now();
+        
+        while (running && executed < maxSteps) {
+            if (currentPc >= codeBytes || (currentPc & alignMask) != 0) {
+                stopReason = (currentPc == codeBytes) ? STOP_END_OF_PROGRAM : STOP_PC_OUT_OF_RANGE;
+                break;
+            }
+            
+            const DecodedInstruction& d = code[currentPc >> shift];
+            
+            if (traceFile) {
+                traceBuffer.push_back(currentPc);
+                if (traceBuffer.size() == (1 << 16)) {
+                    flushTrace();
+                }
+            }
+            
+            // Dependências RAW: a emissão espera os operandos ficarem prontos
+            uint64_t operandsReady = std::max(ready[d.rs1], ready[d.rs2]);
+            if (operandsReady > cycle) {
+                cycle = operandsReady;
+            }
+            uint64_t latency = aluLatency;
+            
+            uint32_t nextPc = currentPc + d.size;
+            uint32_t a = x[d.rs1];
+            uint32_t b = x[d.rs2];
+            uint32_t addr = a + static_cast<uint32_t>(d.imm);
+            
+            switch (d.op) {
+                case OP_ADD:    x[d.rd] = a + b; break;
+                case OP_SUB:    x[d.rd] = a - b; break;
+                case OP_SLL:    x[d.rd] = a << (b & 31); break;
+                case OP_SLT:    x[d.rd] = static_cast<int32_t>(a) < static_cast<int32_t>(b); break;
+                case OP_SLTU:   x[d.rd] = a < b; break;
+                case OP_XOR:    x[d.rd] = a ^ b; break;
+                case OP_SRL:    x[d.rd] = a >> (b & 31); break;
+                case OP_SRA:    x[d.rd] = static_cast<uint32_t>(static_cast<int32_t>(a) >> (b & 31)); break;
+                case OP_OR:     x[d.rd] = a | b; break;
+                case OP_AND:    x[d.rd] = a & b; break;
+                
+                case OP_MUL:    x[d.rd] = a * b; break;
+                case OP_MULH:
+                    x[d.rd] = static_cast<uint32_t>((static_cast<int64_t>(static_cast<int32_t>(a)) *
+                                                     static_cast<int64_t>(static_cast<int32_t>(b))) >> 32);
+                    break;
+                case OP_MULHSU:
+                    x[d.rd] = static_cast<uint32_t>((static_cast<int64_t>(static_cast<int32_t>(a)) *
+                                                     static_cast<int64_t>(b)) >> 32);
+                    break;
+                case OP_MULHU:
+                    x[d.rd] = static_cast<uint32_t>((static_cast<uint64_t>(a) * static_cast<uint64_t>(b)) >> 32);
+                    break;
+                case OP_DIV:
+                    if (b == 0) {
+                        x[d.rd] = 0xFFFFFFFF;
+                    } else if (a == 0x80000000 && b == 0xFFFFFFFF) {
+                        x[d.rd] = a;
+                    } else {
+                        x[d.rd] = static_cast<uint32_t>(static_cast<int32_t>(a) / static_cast<int32_t>(b));
+                    }
+                    break;
+                case OP_DIVU:   x[d.rd] = (b == 0) ? 0xFFFFFFFF : a / b; break;
+                case OP_REM:
+                    if (b == 0) {
+                        x[d.rd] = a;
+                    } else if (a == 0x80000000 && b == 0xFFFFFFFF) {
+                        x[d.rd] = 0;
+                    } else {
+                        x[d.rd] = static_cast<uint32_t>(static_cast<int32_t>(a) % static_cast<int32_t>(b));
+                    }
+                    break;
+                case OP_REMU:   x[d.rd] = (b == 0) ? a : a % b; break;
+                
+                case OP_ADDI:   x[d.rd] = addr; break;
+                case OP_SLTI:   x[d.rd] = static_cast<int32_t>(a) < d.imm; break;
+                case OP_SLTIU:  x[d.rd] = a < static_cast<uint32_t>(d.imm); break;
+                case OP_XORI:   x[d.rd] = a ^ static_cast<uint32_t>(d.imm); break;
+                case OP_ORI:    x[d.rd] = a | static_cast<uint32_t>(d.imm); break;
+                case OP_ANDI:   x[d.rd] = a & static_cast<uint32_t>(d.imm); break;
+                case OP_SLLI:   x[d.rd] = a << d.imm; break;
+                case OP_SRLI:   x[d.rd] = a >> d.imm; break;
+                case OP_SRAI:   x[d.rd] = static_cast<uint32_t>(static_cast<int32_t>(a) >> d.imm); break;
+                
+                case OP_LB:
+                case OP_LBU:
+                    if (addr >= memSize) {
+                        stopReason = STOP_MEMORY_FAULT;
+                        faultAddress = addr;
+                        running = false;
+                        continue;
+                    }
+                    x[d.rd] = (d.op == OP_LB) ? static_cast<uint32_t>(static_cast<int8_t>(mem[addr])) : mem[addr];
+                    latency = loadLatency;
+                    break;
+                case OP_LH:
+                case OP_LHU:
+                    if (addr > memSize - 2) {
+                        stopReason = STOP_MEMORY_FAULT;
+                        faultAddress = addr;
+                        running = false;
+                        continue;
+                    }
+                    {
+                        uint16_t half = static_cast<uint16_t>(mem[addr] | (mem[addr + 1] << 8));
+                        x[d.rd] = (d.op == OP_LH) ? static_cast<uint32_t>(static_cast<int16_t>(half)) : half;
+                    }
+                    latency = loadLatency;
+                    break;
+                case OP_LW:
+                    if (addr > memSize - 4) {
+                        stopReason = STOP_MEMORY_FAULT;
+                        faultAddress = addr;
+                        running = false;
+                        continue;
+                    }
+                    x[d.rd] = readWord(addr);
+                    latency = loadLatency;
+                    break;
+                
+                case OP_SB:
+                    if (addr >= memSize) {
+                        stopReason = STOP_MEMORY_FAULT;
+                        faultAddress = addr;
+                        running = false;
+                        continue;
+                    }
+                    mem[addr] = static_cast<uint8_t>(b);
+                    refreshDecoded(addr);
+                    break;
+                case OP_SH:
+                    if (addr > memSize - 2) {
+                        stopReason = STOP_MEMORY_FAULT;
+                        faultAddress = addr;
+                        running = false;
+                        continue;
+                    }
+                    mem[addr] = static_cast<uint8_t>(b);
+                    mem[addr + 1] = static_cast<uint8_t>(b >> 8);
+                    refreshDecoded(addr);
+                    refreshDecoded(addr + 1);
+                    break;
+                case OP_SW:
+                    if (addr > memSize - 4) {
+                        stopReason = STOP_MEMORY_FAULT;
+                        faultAddress = addr;
+                        running = false;
+                        continue;
+                    }
+                    writeWord(addr, b);
+                    refreshDecoded(addr);
+                    refreshDecoded(addr + 3);
+                    break;
+                
+                case OP_BEQ:  if (a == b) { nextPc = currentPc + d.imm; cycle += branchPenalty; } break;
+                case OP_BNE:  if (a != b) { nextPc = currentPc + d.imm; cycle += branchPenalty; } break;
+                case OP_BLT:
+                    if (static_cast<int32_t>(a) < static_cast<int32_t>(b)) { nextPc = currentPc + d.imm; cycle += branchPenalty; }
+                    break;
+                case OP_BGE:
+                    if (static_cast<int32_t>(a) >= static_cast<int32_t>(b)) { nextPc = currentPc + d.imm; cycle += branchPenalty; }
+                    break;
+                case OP_BLTU: if (a < b) { nextPc = currentPc + d.imm; cycle += branchPenalty; } break;
+                case OP_BGEU: if (a >= b) { nextPc = currentPc + d.imm; cycle += branchPenalty; } break;
+                
+                case OP_LUI:    x[d.rd] = static_cast<uint32_t>(d.imm); break;
+                case OP_AUIPC:  x[d.rd] = currentPc + static_cast<uint32_t>(d.imm); break;
+                case OP_JAL:
+                    x[d.rd] = nextPc;
+                    nextPc = currentPc + d.imm;
+                    cycle += jumpPenalty;
+                    break;
+                case OP_JALR:
+                    x[d.rd] = nextPc;
+                    nextPc = addr & ~1u;
+                    cycle += jumpPenalty;
+                    break;
+                
+                default:
+                    stopReason = STOP_INVALID_INSTRUCTION;
+                    running = false;
+                    continue;
+            }
+            
+            x[0] = 0;
+            ready[d.rd] = cycle + latency;
+            ready[0] = 0;
+            cycle++;
+            executed++;
+            
+            // Um salto para si mesmo ("fim: j fim") encerra a simulação
+            if (nextPc == currentPc) {
+                stopReason = STOP_SELF_LOOP;
+                running = false;
+            }
+            currentPc = nextPc;
+        }
+        
+        auto end = std::chrono::steady_clock::now();
+        elapsedSeconds = std::chrono::duration<double>(end - start).count();
+        flushTrace();
+        
+        pc = currentPc;
+        instret += executed;
+        cycles += cycle + (executed > 0 ? model.fillCycles() : 0);
+        return stopReason;
+    }
+    
+    uint32_t getRegister(int index) const {
+        return regs[index];
+    }
+    
+    uint64_t getRetiredInstructions() const {
+        return instret;
+    }
+    
+    uint64_t getCycles() const {
+        return cycles;
+    }
+    
+    void printReport() const {
+        std::cout << "Simulação encerrada: ";
+        switch (stopReason) {
+            case STOP_END_OF_PROGRAM:
+                std::cout << "fim do programa";
+                break;
+            case STOP_SELF_LOOP:
+                std::cout << "laço infinito em 0x" << std::hex << pc << std::dec;
+                break;
+            case STOP_STEP_LIMIT:
+                std::cout << "limite de passos atingido";
+                break;
+            case STOP_INVALID_INSTRUCTION:
+                std::cout << "instrução inválida em 0x" << std::hex << pc << std::dec;
+                break;
+            case STOP_MEMORY_FAULT:
+                std::cout << "acesso fora da memória (0x" << std::hex << faultAddress
+                          << ") em 0x" << pc << std::dec;
+                break;
+            case STOP_PC_OUT_OF_RANGE:
+                std::cout << "PC fora do programa (0x" << std::hex << pc << std::dec << ")";
+                break;
+        }
+        std::cout << std::endl;
+        
+        std::cout << "Instruções executadas: " << instret << std::endl;
+        std::cout << "Ciclos estimados: " << cycles;
+        if (instret > 0) {
+            std::cout << " (CPI " << std::fixed << std::setprecision(2)
+                      << static_cast<double>(cycles) / instret << std::defaultfloat << ")";
+        }
+        std::cout << std::endl;
+        if (elapsedSeconds > 0.0) {
+            std::cout << "Tempo de simulação: " << std::fixed << std::setprecision(3) << elapsedSeconds
+                      << " s (" << std::setprecision(1) << (instret / elapsedSeconds / 1e6)
+                      << " MIPS)" << std::defaultfloat << std::endl;
+        }
+        
+        std::cout << "Registradores:" << std::endl;
+        for (int i = 0; i < 32; i++) {
+            std::string name = "x" + std::to_string(i) + " (" + ABI_REGISTER_NAMES[i] + ")";
+            std::cout << "  " << std::left << std::setw(11) << name << std::right
+                      << " = 0x" << std::hex << std::setw(8) << std::setfill('0') << regs[i]
+                      << std::setfill(' ') << std::dec;
+            if (i % 4 == 3) {
+                std::cout << std::endl;
+            }
+        }
+    }
+};
+
+// Analisador estático de hazards do pipeline. Percorre a lista de instruções
+// da primeira passagem, encontra dependências RAW (incluindo load-use) e
+// penalidades de desvio segundo o PipelineModel, e estima os ciclos de cada
+// bloco básico, de cada rótulo e de cada iteração dos laços.
+class HazardAnalyzer {
+public:
+    struct Hazard {
+        size_t producer;  // índice da instrução que escreve o registrador
+        size_t consumer;  // índice da instrução que espera
+        int reg;
+        uint64_t stalls;
+        bool loadUse;
+    };
+    
+    struct BasicBlock {
+        size_t first;
+        size_t last;
+        uint64_t cycles;       // emissão das instruções, incluindo bolhas
+        uint64_t stalls;
+        uint64_t exitPenalty;  // custo adicional se o desvio final for tomado
+    };
+    
+    struct Loop {
+        size_t head;
+        size_t latch;           // desvio que fecha o laço
+        uint64_t cycles;        // ciclos por iteração em regime permanente
+        uint64_t stalls;
+    };
+
+private:
+    PipelineModel model;
+    const std::vector<Instruction>& instructions;
+    std::vector<InstructionInfo> info;
+    std::map<uint32_t, std::vector<std::string>> labelsAt;  // endereço -> rótulos
+    std::vector<Hazard> hazards;
+    std::vector<BasicBlock> blocks;
+    std::vector<Loop> loops;
+    
+    // Estado do modelo de emissão em ordem
+    struct IssueState {
+        uint64_t cycle = 0;
+        uint64_t ready[32] = {0};
+        size_t writer[32] = {0};
+    };
+    
+    // Emite as instruções [first, last] em ordem e devolve as bolhas inseridas
+    uint64_t issueRange(size_t first, size_t last, IssueState& state, std::vector<Hazard>* found) const {
+        uint64_t stalls = 0;
+        for (size_t i = first; i <= last; i++) {
+            const InstructionInfo& in = info[i];
+            
+            int sources[2] = {in.rs1, in.rs2};
+            uint64_t issueAt = state.cycle;
+            int waitReg = -1;
+            for (int reg : sources) {
+                if (reg > 0 && state.ready[reg] > issueAt) {
+                    issueAt = state.ready[reg];
+                    waitReg = reg;
+                }
+            }
+            
+            if (waitReg > 0) {
+                uint64_t bubbles = issueAt - state.cycle;
+                stalls += bubbles;
+                if (found) {
+                    size_t producer = state.writer[waitReg];
+                    found->push_back({producer, i, waitReg, bubbles, info[producer].isLoad});
+                }
+            }
+            
+            state.cycle = issueAt + 1;
+            if (in.rd > 0) {
+                state.ready[in.rd] = issueAt + 1 + model.resultLatency(in.isLoad);
+                state.writer[in.rd] = i;
+            }
+        }
+        return stalls;
+    }
+    
+    // Primeira instrução com endereço >= address (info.size() se nenhuma)
+    size_t firstIndexFrom(uint32_t address) const {
+        auto it = std::lower_bound(info.begin(), info.end(), address,
+                                   [](const InstructionInfo& in, uint32_t value) { return in.address < value; });
+        return static_cast<size_t>(it - info.begin());
+    }
+    
+    // Instrução exatamente no endereço dado (info.size() se nenhuma)
+    size_t indexAt(uint32_t address) const {
+        size_t index = firstIndexFrom(address);
+        return (index < info.size() && info[index].address == address) ? index : info.size();
+    }
+    
+    std::string labelFor(size_t index) const {
+        auto it = labelsAt.find(info[index].address);
+        return (it == labelsAt.end()) ? "" : it->second.front();
+    }
+    
+    static std::string location(uint32_t address) {
+        std::ostringstream out;
+        out << "0x" << std::hex << std::setw(4) << std::setfill('0') << address << std::dec;
+        return out.str();
+    }
+    
+    std::string location(size_t index) const {
+        return location(info[index].address);
+    }
+
+public:
+    HazardAnalyzer(const PipelineModel& pipeline, const std::vector<Instruction>& program,
+                   const std::vector<InstructionInfo>& programInfo,
+                   const SymbolTable& symbols)
+        : model(pipeline), instructions(program), info(programInfo) {
+        symbols.forEach([this](const std::string& name, int value) {
+            labelsAt[static_cast<uint32_t>(value)].push_back(name);
+        });
+        for (auto& entry : labelsAt) {
+            std::sort(entry.second.begin(), entry.second.end());
+        }
+    }
+    
+    void analyze() {
+        size_t count = info.size();
+        if (count == 0) {
+            return;
+        }
+        
+        // Líderes: início, instruções com rótulo, destinos de desvio,
+        // instruções seguintes a desvios e saltos e inícios de trechos .org
+        std::vector<bool> leader(count + 1, false);
+        leader[0] = true;
+        for (const auto& entry : labelsAt) {
+            leader[indexAt(entry.first)] = true;
+        }
+        for (size_t i = 0; i < count; i++) {
+            const InstructionInfo& in = info[i];
+            if (in.isBranch || in.isJump) {
+                leader[i + 1] = true;
+                if (in.hasTarget) {
+                    leader[indexAt(in.target)] = true;
+                }
+            }
+            if (i > 0 && in.address != info[i - 1].address + instructions[i - 1].size) {
+                leader[i] = true;
+            }
+        }
+        
+        // Blocos básicos, cada um a partir de um pipeline sem dependências pendentes
+        for (size_t first = 0; first < count;) {
+            size_t last = first;
+            while (last + 1 < count && !leader[last + 1]) {
+                last++;
+            }
+            
+            IssueState state;
+            uint64_t stalls = issueRange(first, last, state, &hazards);
+            uint64_t exitPenalty = info[last].isBranch ? model.branchPenalty
+                                 : info[last].isJump ? model.jumpPenalty : 0;
+            blocks.push_back({first, last, state.cycle, stalls, exitPenalty});
+            first = last + 1;
+        }
+        
+        // Laços: desvios para trás. O custo por iteração é medido na segunda
+        // passada, com as dependências que atravessam a volta do laço.
+        for (size_t i = 0; i < count; i++) {
+            const InstructionInfo& in = info[i];
+            if (!(in.isBranch || in.isJump) || !in.hasTarget || in.target > in.address) {
+                continue;
+            }
+            
+            size_t head = indexAt(in.target);
+            if (head == count) {
+                continue;
+            }
+            uint64_t penalty = in.isBranch ? model.branchPenalty : model.jumpPenalty;
+            IssueState state;
+            issueRange(head, i, state, nullptr);
+            state.cycle += penalty;
+            uint64_t firstPass = state.cycle;
+            uint64_t stalls = issueRange(head, i, state, nullptr);
+            state.cycle += penalty;
+            loops.push_back({head, i, state.cycle - firstPass, stalls});
+        }
+        std::sort(loops.begin(), loops.end(), [](const Loop& a, const Loop& b) {
+            return a.cycles > b.cycles;
+        });
+    }
+    
+    void printReport(size_t maxHazards = 100) const {
+        std::cout << "Modelo de pipeline: " << model.describe() << std::endl;
+        
+        // Hazards de dados e desvios
+        uint64_t loadUseCount = 0;
+        uint64_t totalStalls = 0;
+        for (const Hazard& h : hazards) {
+            loadUseCount += h.loadUse ? 1 : 0;
+            totalStalls += h.stalls;
+        }
+        size_t branchCount = 0;
+        size_t jumpCount = 0;
+        for (const InstructionInfo& in : info) {
+            branchCount += in.isBranch ? 1 : 0;
+            jumpCount += in.isJump ? 1 : 0;
+        }
+        
+        std::cout << std::endl << "Hazards de dados: " << hazards.size() << " (" << loadUseCount
+                  << " load-use), " << totalStalls << " bolha(s)" << std::endl;
+        for (size_t k = 0; k < hazards.size() && k < maxHazards; k++) {
+            const Hazard& h = hazards[k];
+            std::cout << "  " << location(h.producer) << "  " << std::left << std::setw(24)
+                      << instructions[h.producer].toString() << " -> " << location(h.consumer) << "  "
+                      << std::setw(24) << instructions[h.consumer].toString() << std::right
+                      << (h.loadUse ? " load-use" : " RAW") << " em " << ABI_REGISTER_NAMES[h.reg]
+                      << ": " << h.stalls << " ciclo(s)" << std::endl;
+        }
+        if (hazards.size() > maxHazards) {
+            std::cout << "  ... (" << (hazards.size() - maxHazards) << " hazard(s) omitidos)" << std::endl;
+        }
+        std::cout << "Desvios condicionais: " << branchCount << " (+" << model.branchPenalty
+                  << " ciclos se tomados), saltos: " << jumpCount << " (+" << model.jumpPenalty
+                  << " ciclos cada)" << std::endl;
+        
+        // Blocos básicos
+        std::cout << std::endl << "Blocos básicos: " << blocks.size() << std::endl;
+        std::cout << "  Início  Fim     Instr  Ciclos  Bolhas  Saída  Rótulo" << std::endl;
+        uint64_t sequentialCycles = model.fillCycles();
+        for (const BasicBlock& b : blocks) {
+            const InstructionInfo& exit = info[b.last];
+            std::string exitKind = exit.isBranch ? "+" + std::to_string(b.exitPenalty) + "?"
+                                 : exit.isJump ? "+" + std::to_string(b.exitPenalty) : "-";
+            std::cout << "  " << location(b.first) << "  " << location(b.last) << "  "
+                      << std::setw(5) << (b.last - b.first + 1) << "  " << std::setw(6) << b.cycles << "  "
+                      << std::setw(6) << b.stalls << "  " << std::setw(5) << exitKind << "  "
+                      << labelFor(b.first) << std::endl;
+            sequentialCycles += b.cycles + (exit.isJump ? b.exitPenalty : 0);
+        }
+        
+        // Rótulos: ciclos do trecho até o próximo rótulo, sem desvios tomados
+        std::cout << std::endl << "Rótulos (caminho sequencial até o próximo rótulo):" << std::endl;
+        for (auto it = labelsAt.begin(); it != labelsAt.end(); ++it) {
+            size_t first = firstIndexFrom(it->first);
+            auto next = std::next(it);
+            size_t end = (next == labelsAt.end()) ? info.size() : firstIndexFrom(next->first);
+            uint64_t cycles = 0;
+            for (const BasicBlock& b : blocks) {
+                if (b.first >= first && b.first < end) {
+                    cycles += b.cycles + (info[b.last].isJump ? b.exitPenalty : 0);
+                }
+            }
+            for (const std::string& name : it->second) {
+                std::cout << "  " << std::left << std::setw(20) << name << std::right << " " << location(it->first)
+                          << "  " << std::setw(5) << (end > first ? end - first : 0) << " instr  "
+                          << std::setw(6) << cycles << " ciclos" << std::endl;
+            }
+        }
+        
+        // Laços, do mais caro para o mais barato por iteração
+        std::cout << std::endl << "Laços (por iteração, desvio de volta tomado): " << loops.size() << std::endl;
+        for (const Loop& l : loops) {
+            std::string name = labelFor(l.head);
+            std::cout << "  " << std::left << std::setw(20) << (name.empty() ? "(sem rótulo)" : name) << std::right
+                      << " " << location(l.head) << "-" << location(l.latch) << "  " << std::setw(5)
+                      << (l.latch - l.head + 1) << " instr  " << std::setw(6) << l.cycles << " ciclos  "
+                      << l.stalls << " bolha(s)" << std::endl;
+        }
+        
+        std::cout << std::endl << "Estimativa sem desvios condicionais tomados: " << sequentialCycles
+                  << " ciclos para " << info.size() << " instruções" << std::endl;
+    }
+};
+
+// Perfilador dirigido por traço de PCs. Usa a tabela endereço -> fonte gerada
+// por --line-table e lê o traço em blocos de tamanho fixo, com memória
+// constante (um contador por instrução), agregando por linha e por rótulo.
+// O traço pode ser binário (uint32 little-endian, como o de --trace) ou texto
+// com um PC hexadecimal por linha (primeiro campo; "0x" opcional, "#" comenta).
+class TraceProfiler {
+private:
+    static const size_t CHUNK_SIZE = 4 << 20;
+    
+    // Faixa contígua de endereços da tabela; programas com .org têm várias,
+    // e só os endereços presentes ocupam contadores (um por meia palavra,
+    // por causa das instruções comprimidas)
+    struct Region {
+        uint32_t start;
+        uint64_t end;      // primeiro endereço após a faixa
+        size_t firstSlot;
+    };
+    
+    std::vector<std::string> files;
+    std::vector<std::string> labels;
+    std::vector<Region> regions;      // em ordem de endereço
+    std::vector<int> slotFile;        // por meia palavra presente na tabela
+    std::vector<int> slotLine;
+    std::vector<uint32_t> slotLabel;
+    std::vector<uint64_t> counts;
+    size_t lastRegion;                // faixa da amostra anterior
+    uint64_t samples;
+    uint64_t outside;
+    uint64_t bytesRead;
+    double seconds;
+    
+    void count(uint32_t pc) {
+        samples++;
+        if ((pc & 1) != 0 || regions.empty()) {
+            outside++;
+            return;
+        }
+        const Region* region = &regions[lastRegion];
+        if (pc < region->start || pc >= region->end) {
+            auto it = std::upper_bound(regions.begin(), regions.end(), pc,
+                                       [](uint32_t value, const Region& r) { return value < r.start; });
+            if (it == regions.begin() || pc >= std::prev(it)->end) {
+                outside++;
+                return;
+            }
+            lastRegion = static_cast<size_t>(std::prev(it) - regions.begin());
+            region = &regions[lastRegion];
+        }
+        counts[region->firstSlot + ((pc - region->start) >> 1)]++;
+    }
+    
+    static int hexValue(unsigned char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+    
+    static bool looksLikeText(const char* data, size_t size) {
+        for (size_t i = 0; i < size && i < 4096; i++) {
+            unsigned char c = static_cast<unsigned char>(data[i]);
+            if ((c < 0x20 || c > 0x7e) && c != '\t' && c != '\r' && c != '\n') {
+                return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    TraceProfiler() : lastRegion(0), samples(0), outside(0), bytesRead(0), seconds(0.0) {}
+    
+    bool loadTable(const std::string& path) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            std::cerr << "Erro: Não foi possível abrir a tabela de linhas: " << path << std::endl;
+            return false;
+        }
+        
+        std::string line;
+        int lineNumber = 0;
+        std::unordered_map<std::string, uint32_t> labelIds;
+        uint32_t lastInstruction = 0;  // endereço da última instrução da faixa anterior
+        
+        while (std::getline(file, line)) {
+            lineNumber++;
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            
+            std::istringstream fields(line);
+            if (line.compare(0, 8, "arquivo ") == 0) {
+                std::string keyword;
+                size_t id = 0;
+                fields >> keyword >> id;
+                std::string name;
+                std::getline(fields >> std::ws, name);
+                if (files.size() <= id) {
+                    files.resize(id + 1);
+                }
+                files[id] = name;
+                continue;
+            }
+            
+            std::string startHex, endHex, label;
+            int fileId = 0;
+            int sourceLine = 0;
+            if (!(fields >> startHex >> endHex >> fileId >> sourceLine >> label)) {
+                std::cerr << "Erro: Linha " << lineNumber << " inválida na tabela " << path << std::endl;
+                return false;
+            }
+            
+            uint32_t start = static_cast<uint32_t>(std::stoul(startHex, nullptr, 16));
+            uint32_t end = static_cast<uint32_t>(std::stoul(endHex, nullptr, 16));
+            if (labelIds.find(label) == labelIds.end()) {
+                labelIds[label] = static_cast<uint32_t>(labels.size());
+                labels.push_back(label);
+            }
+            
+            // As faixas vêm em ordem de endereço; faixas adjacentes se juntam.
+            // A última instrução de uma faixa ocupa até 4 bytes: se a próxima
+            // faixa começa antes disso, ela era comprimida e a sobra é desfeita.
+            if (end < start || (start & 1) != 0 || (!regions.empty() && start <= lastInstruction)) {
+                std::cerr << "Erro: Faixa fora de ordem na linha " << lineNumber << " da tabela " << path << std::endl;
+                return false;
+            }
+            if (!regions.empty() && start < regions.back().end) {
+                size_t excess = static_cast<size_t>((regions.back().end - start) / 2);
+                slotFile.resize(slotFile.size() - excess);
+                slotLine.resize(slotLine.size() - excess);
+                slotLabel.resize(slotLabel.size() - excess);
+                regions.back().end = start;
+            }
+            if (regions.empty() || regions.back().end != start) {
+                regions.push_back({start, start, slotFile.size()});
+            }
+            regions.back().end = static_cast<uint64_t>(end) + 4;
+            lastInstruction = end;
+            for (uint64_t address = start; address < static_cast<uint64_t>(end) + 4; address += 2) {
+                slotFile.push_back(fileId);
+                slotLine.push_back(sourceLine + static_cast<int>((address - start) / 4));
+                slotLabel.push_back(labelIds[label]);
+            }
+        }
+        
+        counts.assign(slotFile.size(), 0);
+        return true;
+    }
+    
+    bool processTrace(const std::string& path) {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            std::cerr << "Erro: Não foi possível abrir o traço: " << path << std::endl;
+            return false;
+        }
+        
+        std::vector<char> buffer(CHUNK_SIZE);
+        auto start = std::chrono::steady_clock::now();
+        size_t size = std::fread(buffer.data(), 1, buffer.size(), file);
+        bool text = looksLikeText(buffer.data(), size);
+        
+        // Estado do leitor, preservado entre blocos
+        unsigned char carry[4];
+        size_t carried = 0;
+        uint32_t value = 0;
+        int digits = 0;
+        bool lineDone = false;
+        
+        while (size > 0) {
+            bytesRead += size;
+            const unsigned char* data = reinterpret_cast<const unsigned char*>(buffer.data());
+            
+            if (!text) {
+                size_t pos = 0;
+                // Completa a palavra que ficou partida no fim do bloco anterior
+                while (carried > 0 && carried < 4 && pos < size) {
+                    carry[carried++] = data[pos++];
+                }
+                if (carried == 4) {
+                    count(static_cast<uint32_t>(carry[0]) | (static_cast<uint32_t>(carry[1]) << 8) |
+                          (static_cast<uint32_t>(carry[2]) << 16) | (static_cast<uint32_t>(carry[3]) << 24));
+                    carried = 0;
+                }
+                for (; pos + 4 <= size; pos += 4) {
+                    count(static_cast<uint32_t>(data[pos]) | (static_cast<uint32_t>(data[pos + 1]) << 8) |
+                          (static_cast<uint32_t>(data[pos + 2]) << 16) | (static_cast<uint32_t>(data[pos + 3]) << 24));
+                }
+                while (pos < size) {
+                    carry[carried++] = data[pos++];
+                }
+            } else {
+                for (size_t pos = 0; pos < size; pos++) {
+                    unsigned char c = data[pos];
+                    if (c == '\n') {
+                        if (digits > 0 && !lineDone) {
+                            count(value);
+                        }
+                        value = 0;
+                        digits = 0;
+                        lineDone = false;
+                        continue;
+                    }
+                    if (lineDone) {
+                        continue;
+                    }
+                    
+                    int digit = hexValue(c);
+                    if (digit >= 0) {
+                        value = (value << 4) | static_cast<uint32_t>(digit);
+                        digits++;
+                    } else if ((c == 'x' || c == 'X') && digits == 1 && value == 0) {
+                        digits = 0;  // prefixo 0x
+                    } else if (c == '#' && digits == 0) {
+                        lineDone = true;
+                    } else if (digits > 0) {
+                        // Fim do primeiro campo: o resto da linha é ignorado
+                        count(value);
+                        lineDone = true;
+                    }
+                }
+            }
+            
+            size = std::fread(buffer.data(), 1, buffer.size(), file);
+        }
+        
+        if (text && digits > 0 && !lineDone) {
+            count(value);
+        }
+        std::fclose(file);
+        
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (carried != 0) {
+            std::cerr << "Aviso: " << carried << " byte(s) no fim do traço binário foram ignorados" << std::endl;
+        }
+        return true;
+    }
+    
+    // Grava as execuções por linha do fonte, no formato lido por
+    // --layout-profile. A contagem de uma linha é a da sua instrução mais
+    // executada (li/la e desvios relaxados ocupam mais de uma).
+    bool writeLineCounts(const std::string& path) const {
+        std::map<std::pair<int, int>, uint64_t> lineCounts;
+        for (size_t slot = 0; slot < counts.size(); slot++) {
+            if (counts[slot] == 0 || slotFile[slot] < 0) {
+                continue;
+            }
+            uint64_t& value = lineCounts[{slotFile[slot], slotLine[slot]}];
+            value = std::max(value, counts[slot]);
+        }
+        
+        std::ofstream file(path);
+        if (!file.is_open()) {
+            std::cerr << "Erro: Não foi possível abrir o arquivo de saída: " << path << std::endl;
+            return false;
+        }
+        file << "# myRV32I: execuções por linha do fonte" << std::endl;
+        file << "# <linha> <execuções>" << std::endl;
+        int currentFile = -1;
+        for (const auto& entry : lineCounts) {
+            if (entry.first.first != currentFile) {
+                currentFile = entry.first.first;
+                file << "arquivo " << currentFile << ' '
+                     << (currentFile < static_cast<int>(files.size()) ? files[currentFile] : "?") << '\n';
+            }
+            file << entry.first.second << ' ' << entry.second << '\n';
+        }
+        return static_cast<bool>(file);
+    }
+    
+    void printReport(size_t top) const {
+        std::cout << "Traço: " << samples << " amostras (" << std::fixed << std::setprecision(1)
+                  << (bytesRead / 1e6) << " MB em " << std::setprecision(3) << seconds << " s";
+        if (seconds > 0.0) {
+            std::cout << ", " << std::setprecision(0) << (bytesRead / 1e6 / seconds) << " MB/s";
+        }
+        std::cout << std::defaultfloat << ")" << std::endl;
+        if (outside > 0) {
+            std::cout << "Fora da tabela: " << outside << " amostras" << std::endl;
+        }
+        if (samples == 0) {
+            return;
+        }
+        
+        auto percent = [this](uint64_t value) {
+            std::ostringstream out;
+            out << std::fixed << std::setprecision(2) << (100.0 * value / samples) << "%";
+            return out.str();
+        };
+        
+        // Agregação por rótulo e por (arquivo, linha)
+        std::vector<uint64_t> labelCounts(labels.size(), 0);
+        std::map<std::pair<int, int>, std::pair<uint64_t, uint32_t>> lineCounts;
+        for (size_t slot = 0; slot < counts.size(); slot++) {
+            if (counts[slot] == 0 || slotFile[slot] < 0) {
+                continue;
+            }
+            labelCounts[slotLabel[slot]] += counts[slot];
+            auto& entry = lineCounts[{slotFile[slot], slotLine[slot]}];
+            entry.first += counts[slot];
+            entry.second = slotLabel[slot];
+        }
+        
+        std::vector<size_t> labelOrder;
+        for (size_t i = 0; i < labels.size(); i++) {
+            if (labelCounts[i] > 0) {
+                labelOrder.push_back(i);
+            }
+        }
+        std::sort(labelOrder.begin(), labelOrder.end(), [&](size_t a, size_t b) {
+            return labelCounts[a] > labelCounts[b];
+        });
+        
+        std::cout << std::endl << "Rótulos mais executados:" << std::endl;
+        for (size_t k = 0; k < labelOrder.size() && k < top; k++) {
+            size_t i = labelOrder[k];
+            std::cout << "  " << std::setw(14) << labelCounts[i] << "  " << std::setw(7) << percent(labelCounts[i])
+                      << "  " << (labels[i] == "-" ? "(antes do primeiro rótulo)" : labels[i]) << std::endl;
+        }
+        
+        std::vector<std::pair<std::pair<int, int>, std::pair<uint64_t, uint32_t>>> lineOrder(
+            lineCounts.begin(), lineCounts.end());
+        std::sort(lineOrder.begin(), lineOrder.end(), [](const auto& a, const auto& b) {
+            return a.second.first > b.second.first;
+        });
+        
+        // Texto das linhas mais quentes, quando o fonte estiver disponível
+        std::vector<std::vector<std::string>> sources(files.size());
+        for (size_t f = 0; f < files.size(); f++) {
+            std::ifstream source(files[f]);
+            std::string text;
+            while (source.is_open() && std::getline(source, text)) {
+                sources[f].push_back(text);
+            }
+        }
+        
+        std::cout << std::endl << "Linhas mais executadas:" << std::endl;
+        for (size_t k = 0; k < lineOrder.size() && k < top; k++) {
+            int fileId = lineOrder[k].first.first;
+            int line = lineOrder[k].first.second;
+            uint64_t value = lineOrder[k].second.first;
+            std::string where = (fileId < static_cast<int>(files.size()) ? files[fileId] : "?") + ":" + std::to_string(line);
+            std::string text;
+            if (fileId < static_cast<int>(sources.size()) && line > 0 &&
+                line <= static_cast<int>(sources[fileId].size())) {
+                text = sources[fileId][line - 1];
+                text.erase(0, text.find_first_not_of(" \t"));
+            }
+            std::cout << "  " << std::setw(14) << value << "  " << std::setw(7) << percent(value) << "  "
+                      << std::left << std::setw(20) << where << " " << std::setw(16)
+                      << labels[lineOrder[k].second.second] << std::right << " " << text << std::endl;
+        }
+    }
+};
+
+// Desmontador orientado a tabela. Cada palavra é classificada por uma tabela
+// indexada por opcode[6:2], funct3 e funct7, construída a partir dos mesmos
+// descritores (INSTRUCTION_DESCRIPTORS) usados pelos codificadores do montador.
+class Disassembler {
+private:
+    static const uint8_t NO_DESCRIPTOR = 0xFF;
+    
+    // Sintaxe dos operandos de cada descritor
+    enum OperandSyntax : uint8_t {
+        SYNTAX_R,       // rd, rs1, rs2
+        SYNTAX_I,       // rd, rs1, imm
+        SYNTAX_SHIFT,   // rd, rs1, shamt
+        SYNTAX_MEMORY,  // rd, imm(rs1)   (loads e jalr)
+        SYNTAX_S,       // rs2, imm(rs1)
+        SYNTAX_B,       // rs1, rs2, offset
+        SYNTAX_U,       // rd, imm[31:12]
+        SYNTAX_J        // rd, offset
+    };
+    
+    std::vector<uint8_t> lookupTable;  // 2^15 entradas: índice do descritor ou NO_DESCRIPTOR
+    std::vector<OperandSyntax> syntax;
+    
+    static uint32_t lookupIndex(uint32_t word) {
+        return (((word >> 2) & 0x1F) << 10) | (((word >> 12) & 0x7) << 7) | (word >> 25);
+    }
+    
+    static void appendHex(std::string& out, uint32_t value) {
+        static const char digits[] = "0123456789abcdef";
+        char buffer[8];
+        for (int i = 7; i >= 0; i--) {
+            buffer[i] = digits[value & 0xF];
+            value >>= 4;
+        }
+        out.append(buffer, 8);
+    }
+    
+    // Meia palavra de uma instrução comprimida (4 dígitos)
+    static void appendHex16(std::string& out, uint16_t value) {
+        std::string digits;
+        appendHex(digits, value);
+        out.append(digits, 4, 4);
+    }
+    
+    static void appendRegister(std::string& out, uint32_t reg) {
+        out += ABI_REGISTER_NAMES[reg & 0x1F];
+    }
+
+public:
+    Disassembler() : lookupTable(1 << 15, NO_DESCRIPTOR) {
+        for (size_t i = 0; i < INSTRUCTION_DESCRIPTOR_COUNT; i++) {
+            const InstructionDescriptor& desc = INSTRUCTION_DESCRIPTORS[i];
+            uint32_t opcode = std::stoul(desc.opcode, nullptr, 2);
+            
+            OperandSyntax kind = SYNTAX_I;
+            switch (desc.type) {
+                case R_TYPE: kind = SYNTAX_R; break;
+                case S_TYPE: kind = SYNTAX_S; break;
+                case B_TYPE: kind = SYNTAX_B; break;
+                case U_TYPE: kind = SYNTAX_U; break;
+                case J_TYPE: kind = SYNTAX_J; break;
+                default:
+                    if (desc.opcode == "0000011" || desc.mnemonic == "jalr") {
+                        kind = SYNTAX_MEMORY;
+                    } else if (!desc.funct7.empty()) {
+                        kind = SYNTAX_SHIFT;
+                    }
+                    break;
+            }
+            syntax.push_back(kind);
+            
+            // Campos que o formato não possui assumem todos os valores possíveis
+            for (uint32_t f3 = 0; f3 < 8; f3++) {
+                if (!desc.funct3.empty() && f3 != std::stoul(desc.funct3, nullptr, 2)) {
+                    continue;
+                }
+                for (uint32_t f7 = 0; f7 < 128; f7++) {
+                    if (!desc.funct7.empty() && f7 != std::stoul(desc.funct7, nullptr, 2)) {
+                        continue;
+                    }
+                    lookupTable[((opcode >> 2) << 10) | (f3 << 7) | f7] = static_cast<uint8_t>(i);
+                }
+            }
+        }
+    }
+    
+    // Retorna o descritor da palavra, ou nullptr se ela não for uma instrução válida
+    const InstructionDescriptor* find(uint32_t word) const {
+        if ((word & 0x3) != 0x3) {
+            return nullptr;
+        }
+        uint8_t index = lookupTable[lookupIndex(word)];
+        return (index == NO_DESCRIPTOR) ? nullptr : &INSTRUCTION_DESCRIPTORS[index];
+    }
+    
+    // Acrescenta a forma canônica (remontável) da instrução em out.
+    // Retorna false se a palavra não corresponder a nenhuma instrução.
+    bool disassemble(uint32_t word, std::string& out) const {
+        if ((word & 0x3) != 0x3) {
+            return false;
+        }
+        uint8_t index = lookupTable[lookupIndex(word)];
+        if (index == NO_DESCRIPTOR) {
+            return false;
+        }
+        
+        uint32_t rd = (word >> 7) & 0x1F;
+        uint32_t rs1 = (word >> 15) & 0x1F;
+        uint32_t rs2 = (word >> 20) & 0x1F;
+        int32_t immI = static_cast<int32_t>(word) >> 20;
+        
+        out += INSTRUCTION_DESCRIPTORS[index].mnemonic;
+        out += ' ';
+        
+        switch (syntax[index]) {
+            case SYNTAX_R:
+                appendRegister(out, rd);
+                out += ", ";
+                appendRegister(out, rs1);
+                out += ", ";
+                appendRegister(out, rs2);
+                break;
+            case SYNTAX_I:
+                appendRegister(out, rd);
+                out += ", ";
+                appendRegister(out, rs1);
+                out += ", ";
+                out += std::to_string(immI);
+                break;
+            case SYNTAX_SHIFT:
+                appendRegister(out, rd);
+                out += ", ";
+                appendRegister(out, rs1);
+                out += ", ";
+                out += std::to_string(rs2);
+                break;
+            case SYNTAX_MEMORY:
+                appendRegister(out, rd);
+                out += ", ";
+                out += std::to_string(immI);
+                out += '(';
+                appendRegister(out, rs1);
+                out += ')';
+                break;
+            case SYNTAX_S: {
+                int32_t immS = (static_cast<int32_t>(word & 0xFE000000) >> 20) | ((word >> 7) & 0x1F);
+                appendRegister(out, rs2);
+                out += ", ";
+                out += std::to_string(immS);
+                out += '(';
+                appendRegister(out, rs1);
+                out += ')';
+                break;
+            }
+            case SYNTAX_B: {
+                int32_t immB = (static_cast<int32_t>(word & 0x80000000) >> 19) | ((word & 0x80) << 4) |
+                               ((word >> 20) & 0x7E0) | ((word >> 7) & 0x1E);
+                appendRegister(out, rs1);
+                out += ", ";
+                appendRegister(out, rs2);
+                out += ", ";
+                out += std::to_string(immB);
+                break;
+            }
+            case SYNTAX_U:
+                appendRegister(out, rd);
+                out += ", ";
+                out += std::to_string(word >> 12);
+                break;
+            case SYNTAX_J: {
+                int32_t immJ = (static_cast<int32_t>(word & 0x80000000) >> 11) | (word & 0xFF000) |
+                               ((word >> 9) & 0x800) | ((word >> 20) & 0x7FE);
+                appendRegister(out, rd);
+                out += ", ";
+                out += std::to_string(immJ);
+                break;
+            }
+        }
+        return true;
+    }
+    
+    // Desmonta uma imagem inteira. Cada trecho fora da sequência começa com
+    // ".org"; cada linha traz endereço e palavra em comentário, e o texto pode
+    // ser remontado.
+    std::string disassembleProgram(const MemoryImage& image) const {
+        std::string out;
+        out.reserve(image.wordCount() * 56);
+        uint64_t expected = 0;
+        
+        for (const auto& segment : image.getSegments()) {
+            if (segment.first != expected) {
+                out += "    .org 0x";
+                appendHex(out, segment.first);
+                out += '\n';
+            }
+            
+            // Percorre o trecho por meias palavras: bits [1:0] != 11 indicam uma
+            // instrução comprimida. Palavras alinhadas que não decodificam são
+            // mostradas inteiras, como antes da compressão existir.
+            const std::vector<uint32_t>& words = segment.second;
+            size_t halves = words.size() * 2;
+            auto halfAt = [&words](size_t k) {
+                return static_cast<uint16_t>(words[k / 2] >> (16 * (k % 2)));
+            };
+            for (size_t k = 0; k < halves;) {
+                uint32_t address = segment.first + static_cast<uint32_t>(k * 2);
+                uint16_t half = halfAt(k);
+                if (half == 0 && k % 2 == 1 && k + 1 == halves) {
+                    break; // enchimento da última palavra do trecho
+                }
+                bool compressed = (half & 3) != 3;
+                uint32_t word = 0;
+                if (compressed) {
+                    word = CompressedCodec::expand(half);
+                    if (word == 0 && k % 2 == 0) {
+                        compressed = false;
+                        word = words[k / 2];
+                    }
+                } else if (k + 1 < halves) {
+                    word = half | (static_cast<uint32_t>(halfAt(k + 1)) << 16);
+                }
+                size_t lineStart = out.size();
+                k += compressed ? 1 : 2;
+                
+                out += compressed ? "    c." : "    ";
+                if (word == 0 || !disassemble(word, out)) {
+                    out.resize(lineStart);
+                    out += "    # 0x";
+                    appendHex(out, address);
+                    out += ": ";
+                    if (compressed || k > halves) {
+                        appendHex16(out, half);
+                    } else {
+                        appendHex(out, word);
+                    }
+                    out += " (instrução desconhecida)\n";
+                    continue;
+                }
+                
+                size_t width = out.size() - lineStart;
+                out.append(width < 36 ? 36 - width : 1, ' ');
+                out += "# 0x";
+                appendHex(out, address);
+                out += ": ";
+                if (compressed) {
+                    appendHex16(out, half);
+                } else {
+                    appendHex(out, word);
+                }
+                
+                // Destino absoluto de branches e jal
+                uint32_t opcode = word & 0x7F;
+                if (opcode == 0x63 || opcode == 0x6F) {
+                    int32_t offset = (opcode == 0x63)
+                        ? ((static_cast<int32_t>(word & 0x80000000) >> 19) | ((word & 0x80) << 4) |
+                           ((word >> 20) & 0x7E0) | ((word >> 7) & 0x1E))
+                        : ((static_cast<int32_t>(word & 0x80000000) >> 11) | (word & 0xFF000) |
+                           ((word >> 9) & 0x800) | ((word >> 20) & 0x7FE));
+                    out += " -> 0x";
+                    appendHex(out, address + static_cast<uint32_t>(offset));
+                }
+                out += '\n';
+            }
+            expected = static_cast<uint64_t>(segment.first) + words.size() * 4;
+        }
+        return out;
+    }
+    
+    // Desmonta e remonta a imagem, verificando se os bits se mantêm em cada endereço
+    bool verify(const MemoryImage& original) const {
+        std::string text = disassembleProgram(original);
+        
+        Assembler reassembler("", "");
+        reassembler.setQuietMode(true);
+        std::istringstream source(text);
+        if (!reassembler.assemble(source)) {
+            std::cerr << "Erro: Falha ao remontar o código desmontado" << std::endl;
+            return false;
+        }
+        
+        const MemoryImage& rebuilt = reassembler.getImage();
+        size_t mismatches = 0;
+        
+        // Linha desmontada de cada endereço, pelo comentário "# 0x<endereço>:"
+        std::map<uint32_t, std::string> lineAt;
+        std::istringstream lines(text);
+        std::string line;
+        while (std::getline(lines, line)) {
+            size_t mark = line.find("# 0x");
+            if (mark != std::string::npos) {
+                lineAt[static_cast<uint32_t>(std::strtoul(line.c_str() + mark + 4, nullptr, 16))] = line;
+            }
+        }
+        
+        auto report = [&](uint64_t address, bool hasOriginal, uint32_t originalWord,
+                          bool hasRebuilt, uint32_t rebuiltWord) {
+            auto it = lineAt.upper_bound(static_cast<uint32_t>(address + 3));
+            line = (it == lineAt.begin()) ? "" : std::prev(it)->second;
+            if (++mismatches <= 20) {
+                std::cerr << "Divergência em 0x" << std::hex << std::setw(8) << std::setfill('0') << address
+                          << ": original " << std::setw(8) << (hasOriginal ? originalWord : 0)
+                          << ", remontado " << std::setw(8) << (hasRebuilt ? rebuiltWord : 0)
+                          << std::setfill(' ') << std::dec << "  |" << line << std::endl;
+            }
+        };
+        
+        for (const auto& segment : original.getSegments()) {
+            for (size_t i = 0; i < segment.second.size(); i++) {
+                uint32_t address = segment.first + static_cast<uint32_t>(i * 4);
+                uint32_t word = 0;
+                bool hasRebuilt = rebuilt.wordAt(address, word);
+                if (!hasRebuilt || word != segment.second[i]) {
+                    report(address, true, segment.second[i], hasRebuilt, word);
+                }
+            }
+        }
+        for (const auto& segment : rebuilt.getSegments()) {
+            for (size_t i = 0; i < segment.second.size(); i++) {
+                uint32_t address = segment.first + static_cast<uint32_t>(i * 4);
+                uint32_t word = 0;
+                if (!original.wordAt(address, word)) {
+                    report(address, false, 0, true, segment.second[i]);
+                }
+            }
+        }
+        
+        if (mismatches > 0) {
+            std::cerr << "Verificação falhou: " << mismatches << " de " << original.wordCount()
+                      << " palavras divergem" << std::endl;
+            return false;
+        }
+        
+        std::cout << "Verificação concluída: " << original.wordCount()
+                  << " palavras idênticas após desmontar e remontar" << std::endl;
+        return true;
+    }
+};
+
+// Teste diferencial aleatório dos codificadores. Gera instruções válidas de
+// todos os formatos e faixas de imediato, codifica pelo caminho normal do
+// montador (operandos em texto) e compara com um empacotador de bits de
+// referência independente, escrito direto a partir da especificação RV32IM.
+// Divergências são reduzidas a um caso mínimo antes de serem relatadas.
+class EncoderFuzzer {
+public:
+    // Instrução gerada, em campos numéricos
+    struct FuzzCase {
+        size_t reference;   // índice em REFERENCE_ENCODINGS
+        int rd;
+        int rs1;
+        int rs2;
+        int32_t imm;
+        bool abiNames;      // registradores por nome ABI (a0) ou numérico (x10)
+        bool useLabel;      // branches/jal: destino por rótulo em vez de offset numérico
+    };
+    
+private:
+    // Codificação de referência: formato, opcode, funct3 e funct7 de cada mnemônico
+    struct ReferenceEncoding {
+        const char* mnemonic;
+        char format;  // R, I, H (shift), L (load/jalr), S, B, U, J
+        uint32_t opcode;
+        uint32_t funct3;
+        uint32_t funct7;
+    };
+    
+    static const ReferenceEncoding REFERENCE_ENCODINGS[];
+    static const size_t REFERENCE_COUNT;
+    
+    Assembler assembler;
+    std::mt19937_64 rng;
+    
+    // Imediato aleatório em [min, max], múltiplo de align, com viés para os extremos
+    int32_t randomImmediate(int32_t min, int32_t max, int32_t align) {
+        switch (rng() % 8) {
+            case 0: return min;
+            case 1: return max;
+            case 2: return 0;
+            case 3: return (rng() & 1) || min == 0 ? align : -align;
+            case 4: {
+                // Potências de dois e vizinhas (fronteiras entre grupos de bits)
+                int bit = static_cast<int>(rng() % 31);
+                int64_t value = (int64_t(1) << bit) * ((rng() & 1) ? 1 : -1) + static_cast<int>(rng() % 3) - 1;
+                value -= value % align;
+                if (value >= min && value <= max) {
+                    return static_cast<int32_t>(value);
+                }
+                return 0;
+            }
+            default: {
+                uint64_t span = static_cast<uint64_t>((static_cast<int64_t>(max) - min) / align) + 1;
+                return min + static_cast<int32_t>(rng() % span) * align;
+            }
+        }
+    }
+    
+    std::string registerName(int reg, bool abi) const {
+        return abi ? ABI_REGISTER_NAMES[reg] : "x" + std::to_string(reg);
+    }
+    
+    // Monta a instrução textual equivalente ao caso
+    Instruction toInstruction(const FuzzCase& c) const {
+        const ReferenceEncoding& ref = REFERENCE_ENCODINGS[c.reference];
+        std::string rd = registerName(c.rd, c.abiNames);
+        std::string rs1 = registerName(c.rs1, c.abiNames);
+        std::string rs2 = registerName(c.rs2, c.abiNames);
+        std::string imm = std::to_string(c.imm);
+        
+        switch (ref.format) {
+            case 'R': return Instruction("", ref.mnemonic, {rd, rs1, rs2});
+            case 'I':
+            case 'H': return Instruction("", ref.mnemonic, {rd, rs1, imm});
+            case 'L': return Instruction("", ref.mnemonic, {rd, imm + "(" + rs1 + ")"});
+            case 'S': return Instruction("", ref.mnemonic, {rs2, imm + "(" + rs1 + ")"});
+            case 'B': return Instruction("", ref.mnemonic, {rs1, rs2, c.useLabel ? "alvo" : imm});
+            case 'U': return Instruction("", ref.mnemonic, {rd, imm});
+            default:  return Instruction("", ref.mnemonic, {rd, c.useLabel ? "alvo" : imm});
+        }
+    }
+    
+    // Codificação direta por deslocamentos de bits, independente do montador
+    static uint32_t referenceEncode(const FuzzCase& c) {
+        const ReferenceEncoding& ref = REFERENCE_ENCODINGS[c.reference];
+        uint32_t imm = static_cast<uint32_t>(c.imm);
+        uint32_t rd = static_cast<uint32_t>(c.rd) << 7;
+        uint32_t rs1 = static_cast<uint32_t>(c.rs1) << 15;
+        uint32_t rs2 = static_cast<uint32_t>(c.rs2) << 20;
+        uint32_t funct3 = ref.funct3 << 12;
+        
+        switch (ref.format) {
+            case 'R':
+                return (ref.funct7 << 25) | rs2 | rs1 | funct3 | rd | ref.opcode;
+            case 'I':
+            case 'L':
+                return ((imm & 0xFFF) << 20) | rs1 | funct3 | rd | ref.opcode;
+            case 'H':
+                return (ref.funct7 << 25) | ((imm & 0x1F) << 20) | rs1 | funct3 | rd | ref.opcode;
+            case 'S':
+                return (((imm >> 5) & 0x7F) << 25) | rs2 | rs1 | funct3 | ((imm & 0x1F) << 7) | ref.opcode;
+            case 'B':
+                return (((imm >> 12) & 0x1) << 31) | (((imm >> 5) & 0x3F) << 25) | rs2 | rs1 | funct3 |
+                       (((imm >> 1) & 0xF) << 8) | (((imm >> 11) & 0x1) << 7) | ref.opcode;
+            case 'U':
+                return ((imm & 0xFFFFF) << 12) | rd | ref.opcode;
+            default:
+                return (((imm >> 20) & 0x1) << 31) | (((imm >> 1) & 0x3FF) << 21) | (((imm >> 11) & 0x1) << 20) |
+                       (((imm >> 12) & 0xFF) << 12) | rd | ref.opcode;
+        }
+    }
+    
+    // Codifica o caso pelo caminho normal do montador. Rótulos são resolvidos
+    // com a instrução no endereço 0 e o símbolo "alvo" no endereço do offset.
+    bool assemblerEncode(const FuzzCase& c, uint32_t& word) {
+        assembler.instructions[0] = toInstruction(c);
+        if (c.useLabel) {
+            assembler.symbolTable.define("alvo", c.imm);
+        }
+        std::string binary = assembler.encodeToBinary(assembler.instructions[0]);
+        if (binary.size() != 32) {
+            return false;
+        }
+        word = static_cast<uint32_t>(std::stoul(binary, nullptr, 2));
+        return true;
+    }
+    
+    bool fails(const FuzzCase& c) {
+        uint32_t word = 0;
+        return !assemblerEncode(c, word) || word != referenceEncode(c);
+    }
+    
+    // Reduz um caso divergente: zera registradores, usa nomes numéricos, troca
+    // rótulo por offset e aproxima o imediato de zero enquanto a falha persistir
+    FuzzCase shrink(FuzzCase c) {
+        const ReferenceEncoding& ref = REFERENCE_ENCODINGS[c.reference];
+        int32_t align = (ref.format == 'B' || ref.format == 'J') ? 2 : 1;
+        bool progress = true;
+        
+        while (progress) {
+            progress = false;
+            std::vector<FuzzCase> candidates;
+            
+            FuzzCase t = c;
+            if (c.rd != 0) { t = c; t.rd = 0; candidates.push_back(t); }
+            if (c.rs1 != 0) { t = c; t.rs1 = 0; candidates.push_back(t); }
+            if (c.rs2 != 0) { t = c; t.rs2 = 0; candidates.push_back(t); }
+            if (c.abiNames) { t = c; t.abiNames = false; candidates.push_back(t); }
+            if (c.useLabel) { t = c; t.useLabel = false; candidates.push_back(t); }
+            if (c.imm != 0) {
+                t = c; t.imm = 0; candidates.push_back(t);
+                t = c; t.imm = (c.imm / 2) - (c.imm / 2) % align; candidates.push_back(t);
+                t = c; t.imm = c.imm > 0 ? c.imm - align : c.imm + align; candidates.push_back(t);
+            }
+            
+            for (const FuzzCase& candidate : candidates) {
+                if (fails(candidate)) {
+                    c = candidate;
+                    progress = true;
+                    break;
+                }
+            }
+        }
+        return c;
+    }
+
+public:
+    EncoderFuzzer(uint64_t seed) : assembler("", ""), rng(seed) {
+        assembler.setQuietMode(true);
+        assembler.initRegisterTable();
+        assembler.initOpcodeTable();
+        assembler.instructions.resize(1);
+    }
+    
+    FuzzCase randomCase() {
+        FuzzCase c;
+        c.reference = rng() % REFERENCE_COUNT;
+        c.rd = static_cast<int>(rng() % 32);
+        c.rs1 = static_cast<int>(rng() % 32);
+        c.rs2 = static_cast<int>(rng() % 32);
+        c.abiNames = (rng() & 1) != 0;
+        c.useLabel = (rng() & 1) != 0;
+        
+        switch (REFERENCE_ENCODINGS[c.reference].format) {
+            case 'I':
+            case 'L':
+            case 'S': c.imm = randomImmediate(-2048, 2047, 1); break;
+            case 'H': c.imm = randomImmediate(0, 31, 1); break;
+            case 'B': c.imm = randomImmediate(-4096, 4094, 2); break;
+            case 'U': c.imm = randomImmediate(-524288, 0xFFFFF, 1); break;
+            case 'J': c.imm = randomImmediate(-1048576, 1048574, 2); break;
+            default:  c.imm = 0; break;
+        }
+        return c;
+    }
+    
+    // Executa até iterations casos; em caso de divergência, devolve o caso reduzido
+    bool run(uint64_t iterations, const std::atomic<bool>& stop, uint64_t& executed, FuzzCase& failure) {
+        executed = 0;
+        while (executed < iterations && !stop.load(std::memory_order_relaxed)) {
+            // Lotes curtos entre consultas ao sinal de parada
+            for (int i = 0; i < 256 && executed < iterations; i++, executed++) {
+                FuzzCase c = randomCase();
+                if (fails(c)) {
+                    failure = shrink(c);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+    
+    std::string describe(const FuzzCase& c) {
+        Instruction instr = toInstruction(c);
+        std::string text = instr.opcode;
+        for (size_t i = 0; i < instr.operands.size(); i++) {
+            text += (i == 0 ? " " : ", ") + instr.operands[i];
+        }
+        if (c.useLabel) {
+            text += "    (alvo = " + std::to_string(c.imm) + ")";
+        }
+        
+        std::ostringstream out;
+        uint32_t word = 0;
+        out << text << std::endl << "  esperado: 0x" << std::hex << std::setw(8) << std::setfill('0')
+            << referenceEncode(c) << std::endl << "  obtido:   ";
+        if (assemblerEncode(c, word)) {
+            out << "0x" << std::setw(8) << word;
+        } else {
+            out << "(falha na codificação)";
+        }
+        return out.str();
+    }
+    
+    // Distribui as iterações entre as threads; retorna false se houver divergência
+    static bool runParallel(uint64_t iterations, uint64_t seed) {
+        unsigned threadCount = std::max(1u, std::thread::hardware_concurrency());
+        std::atomic<bool> stop(false);
+        std::atomic<uint64_t> total(0);
+        std::mutex failureMutex;
+        bool failed = false;
+        std::string report;
+        std::vector<std::thread> threads;
+        
+        std::cout << "Testando codificadores: " << iterations << " instruções aleatórias, semente " << seed
+                  << ", " << threadCount << " threads" << std::endl;
+        auto start = std::chrono::steady_clock::now();
+        
+        // As mensagens de erro dos codificadores são descartadas durante o teste;
+        // a divergência é relatada ao final, já reduzida
+        std::streambuf* errorBuffer = std::cerr.rdbuf(nullptr);
+        
+        for (unsigned t = 0; t < threadCount; t++) {
+            uint64_t share = iterations / threadCount + (t < iterations % threadCount ? 1 : 0);
+            threads.emplace_back([&, t, share]() {
+                EncoderFuzzer fuzzer(seed + t * 0x9E3779B97F4A7C15ULL);
+                uint64_t executed = 0;
+                FuzzCase failure;
+                bool ok = fuzzer.run(share, stop, executed, failure);
+                total += executed;
+                if (!ok) {
+                    std::lock_guard<std::mutex> lock(failureMutex);
+                    if (!failed) {
+                        failed = true;
+                        report = fuzzer.describe(failure);
+                    }
+                    stop = true;
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        std::cerr.rdbuf(errorBuffer);
+        std::cerr.clear();
+        
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << total.load() << " instruções verificadas em " << std::fixed << std::setprecision(2) << seconds
+                  << " s (" << std::setprecision(2) << (total.load() / seconds / 1e6) << " M/s)"
+                  << std::defaultfloat << std::endl;
+        
+        if (failed) {
+            std::cerr << "Divergência encontrada (caso mínimo):" << std::endl << report << std::endl;
+            return false;
+        }
+        std::cout << "Nenhuma divergência encontrada." << std::endl;
+        return true;
+    }
+};
+
+const EncoderFuzzer::ReferenceEncoding EncoderFuzzer::REFERENCE_ENCODINGS[] = {
+    {"add",    'R', 0x33, 0, 0x00}, {"sub",   'R', 0x33, 0, 0x20},
+    {"sll",    'R', 0x33, 1, 0x00}, {"slt",   'R', 0x33, 2, 0x00},
+    {"sltu",   'R', 0x33, 3, 0x00}, {"xor",   'R', 0x33, 4, 0x00},
+    {"srl",    'R', 0x33, 5, 0x00}, {"sra",   'R', 0x33, 5, 0x20},
+    {"or",     'R', 0x33, 6, 0x00}, {"and",   'R', 0x33, 7, 0x00},
+    {"mul",    'R', 0x33, 0, 0x01}, {"mulh",  'R', 0x33, 1, 0x01},
+    {"mulhsu", 'R', 0x33, 2, 0x01}, {"mulhu", 'R', 0x33, 3, 0x01},
+    {"div",    'R', 0x33, 4, 0x01}, {"divu",  'R', 0x33, 5, 0x01},
+    {"rem",    'R', 0x33, 6, 0x01}, {"remu",  'R', 0x33, 7, 0x01},
+    {"addi",   'I', 0x13, 0, 0},    {"slti",  'I', 0x13, 2, 0},
+    {"sltiu",  'I', 0x13, 3, 0},    {"xori",  'I', 0x13, 4, 0},
+    {"ori",    'I', 0x13, 6, 0},    {"andi",  'I', 0x13, 7, 0},
+    {"slli",   'H', 0x13, 1, 0x00}, {"srli",  'H', 0x13, 5, 0x00},
+    {"srai",   'H', 0x13, 5, 0x20},
+    {"lb",     'L', 0x03, 0, 0},    {"lh",    'L', 0x03, 1, 0},
+    {"lw",     'L', 0x03, 2, 0},    {"lbu",   'L', 0x03, 4, 0},
+    {"lhu",    'L', 0x03, 5, 0},    {"jalr",  'L', 0x67, 0, 0},
+    {"sb",     'S', 0x23, 0, 0},    {"sh",    'S', 0x23, 1, 0},
+    {"sw",     'S', 0x23, 2, 0},
+    {"beq",    'B', 0x63, 0, 0},    {"bne",   'B', 0x63, 1, 0},
+    {"blt",    'B', 0x63, 4, 0},    {"bge",   'B', 0x63, 5, 0},
+    {"bltu",   'B', 0x63, 6, 0},    {"bgeu",  'B', 0x63, 7, 0},
+    {"lui",    'U', 0x37, 0, 0},    {"auipc", 'U', 0x17, 0, 0},
+    {"jal",    'J', 0x6F, 0, 0}
+};
+
+const size_t EncoderFuzzer::REFERENCE_COUNT =
+    sizeof(EncoderFuzzer::REFERENCE_ENCODINGS) / sizeof(EncoderFuzzer::REFERENCE_ENCODINGS[0]);
+
+#if defined(__unix__) || defined(__APPLE__)
+// Servidor de montagem local (--serve) em um socket Unix. Cada thread de
+// trabalho mantém um Assembler já inicializado e atende uma conexão por vez;
+// cada conexão pode enviar várias requisições em sequência. Protocolo:
+//   requisição: "MONTAR <bytes> [escalonar] [comprimir] [otimizar-cfg] [perfil=...]
+//               [pipeline=...]\n" + código-fonte
+//   resposta:   "OK <trechos> <bytes>\n" + trechos + diagnósticos
+//               "ERRO <bytes>\n" + diagnósticos
+//   trecho:     "<endereço hex> <palavras>\n" + palavras (uint32 little-endian)
+//   requisição: "VERIFICAR <bytes>\n" + código-fonte (--check)
+//   resposta:   "OK <diagnósticos> <bytes>\n" + JSON
+class AssemblerServer {
+private:
+    static const size_t MAX_HEADER = 4096;
+    static const size_t MAX_SOURCE = size_t(1) << 30;
+    
+    // Leitura com buffer de um descritor de socket
+    class SocketReader {
+    private:
+        int fd;
+        char buffer[65536];
+        size_t pos;
+        size_t size;
+        
+        bool fill() {
+            ssize_t received;
+            do {
+                received = ::read(fd, buffer, sizeof(buffer));
+            } while (received < 0 && errno == EINTR);
+            if (received <= 0) {
+                return false;
+            }
+            pos = 0;
+            size = static_cast<size_t>(received);
+            return true;
+        }
+    
+    public:
+        explicit SocketReader(int descriptor) : fd(descriptor), pos(0), size(0) {}
+        
+        bool readLine(std::string& line, size_t maxLength) {
+            line.clear();
+            for (;;) {
+                if (pos == size && !fill()) {
+                    return false;
+                }
+                const char* start = buffer + pos;
+                const char* newline = static_cast<const char*>(std::memchr(start, '\n', size - pos));
+                size_t length = newline ? static_cast<size_t>(newline - start) : size - pos;
+                line.append(start, length);
+                pos += length;
+                if (newline) {
+                    pos++;
+                    return true;
+                }
+                if (line.size() > maxLength) {
+                    return false;
+                }
+            }
+        }
+        
+        bool read(char* out, size_t count) {
+            while (count > 0) {
+                if (pos == size && !fill()) {
+                    return false;
+                }
+                size_t chunk = std::min(count, size - pos);
+                std::memcpy(out, buffer + pos, chunk);
+                pos += chunk;
+                out += chunk;
+                count -= chunk;
+            }
+            return true;
+        }
+    };
+    
+    std::string socketPath;
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::deque<int> pending;
+    std::atomic<uint64_t> served;
+    std::shared_ptr<Assembler::CheckCache> checkCache;  // comum a todas as threads
+    
+    static bool writeAll(int fd, const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t sent = ::write(fd, data, size);
+            if (sent < 0 && errno == EINTR) {
+                continue;
+            }
+            if (sent <= 0) {
+                return false;
+            }
+            data += sent;
+            size -= static_cast<size_t>(sent);
+        }
+        return true;
+    }
+    
+    // Conecta ao servidor em path; -1 (com a mensagem já impressa) em caso de erro
+    static int connectTo(const std::string& path) {
+        sockaddr_un address{};
+        if (path.size() >= sizeof(address.sun_path)) {
+            std::cerr << "Erro: Caminho do socket muito longo: " << path << std::endl;
+            return -1;
+        }
+        address.sun_family = AF_UNIX;
+        std::strcpy(address.sun_path, path.c_str());
+        
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            std::cerr << "Erro: Não foi possível conectar a " << path << ": " << std::strerror(errno) << std::endl;
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            return -1;
+        }
+        return fd;
+    }
+    
+    // Atende uma requisição já lida; devolve a resposta completa
+    static std::string handleRequest(Assembler& assembler, const std::vector<std::string>& options,
+                                     const std::string& sourceText) {
+        std::ostringstream diagnostics;
+        assembler.setDiagnosticStream(diagnostics);
+        assembler.disableScheduling();
+        assembler.setCompression(false);
+        assembler.setCfgOptimization(false);
+        assembler.clearLayoutProfile();
+        
+        bool optionsValid = true;
+        bool schedule = false;
+        PipelineModel model;
+        for (const std::string& option : options) {
+            if (option == "escalonar") {
+                schedule = true;
+            } else if (option == "comprimir") {
+                assembler.setCompression(true);
+            } else if (option == "otimizar-cfg") {
+                assembler.setCfgOptimization(true);
+            } else if (option.compare(0, 7, "perfil=") == 0) {
+                optionsValid = assembler.loadLayoutProfile(option.substr(7)) && optionsValid;
+            } else if (option.compare(0, 9, "pipeline=") == 0) {
+                if (!model.parse(option.substr(9))) {
+                    optionsValid = false;
+                    diagnostics << "Erro: Parâmetros de pipeline inválidos: " << option.substr(9) << "\n";
+                }
+            } else {
+                diagnostics << "Erro: Opção desconhecida: " << option << "\n";
+                optionsValid = false;
+            }
+        }
+        if (schedule) {
+            assembler.enableScheduling(model);
+        }
+        
+        std::istringstream source(sourceText);
+        bool ok = optionsValid && assembler.assemble(source);
+        std::string text = diagnostics.str();
+        std::string response;
+        if (!ok) {
+            response = "ERRO " + std::to_string(text.size()) + "\n" + text;
+            return response;
+        }
+        
+        // Cada trecho da imagem: "<endereço hex> <palavras>\n" seguido das palavras
+        const MemoryImage::SegmentMap& segments = assembler.getImage().getSegments();
+        response = "OK " + std::to_string(segments.size()) + " " + std::to_string(text.size()) + "\n";
+        for (const auto& segment : segments) {
+            const std::vector<uint32_t>& words = segment.second;
+            char line[32];
+            std::snprintf(line, sizeof(line), "%x %zu\n", segment.first, words.size());
+            response += line;
+            size_t header = response.size();
+            response.resize(header + words.size() * 4);
+            for (size_t i = 0; i < words.size(); i++) {
+                for (int byte = 0; byte < 4; byte++) {
+                    response[header + i * 4 + byte] = static_cast<char>((words[i] >> (byte * 8)) & 0xFF);
+                }
+            }
+        }
+        response += text;
+        return response;
+    }
+    
+    // Requisição do --check: só a verificação, com o cache de trechos
+    static std::string handleCheck(Assembler& assembler, const std::string& sourceText) {
+        std::vector<Assembler::Diagnostic> diagnostics = assembler.check(sourceText);
+        std::string json = Assembler::diagnosticsJson(diagnostics);
+        return "OK " + std::to_string(diagnostics.size()) + " " + std::to_string(json.size()) + "\n" + json;
+    }
+    
+    void serveConnection(int fd, Assembler& assembler) {
+        SocketReader reader(fd);
+        std::string header;
+        while (reader.readLine(header, MAX_HEADER)) {
+            std::istringstream fields(header);
+            std::string command;
+            size_t length = 0;
+            fields >> command >> length;
+            if ((command != "MONTAR" && command != "VERIFICAR") || !fields || length > MAX_SOURCE) {
+                std::string message = "Erro: Requisição inválida\n";
+                std::string response = "ERRO " + std::to_string(message.size()) + "\n" + message;
+                writeAll(fd, response.data(), response.size());
+                break;
+            }
+            
+            std::vector<std::string> options;
+            std::string option;
+            while (fields >> option) {
+                options.push_back(option);
+            }
+            
+            std::string source(length, '\0');
+            if (!reader.read(&source[0], length)) {
+                break;
+            }
+            std::string response = command == "VERIFICAR" ? handleCheck(assembler, source)
+                                                          : handleRequest(assembler, options, source);
+            if (!writeAll(fd, response.data(), response.size())) {
+                break;
+            }
+            served++;
+        }
+        ::close(fd);
+    }
+    
+    void worker() {
+        Assembler assembler("", "");
+        assembler.setQuietMode(true);
+        assembler.setCheckCache(checkCache);
+        // Aquece as tabelas de registradores e opcodes antes da primeira requisição
+        std::istringstream empty("");
+        assembler.assemble(empty);
+        
+        for (;;) {
+            int fd;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueReady.wait(lock, [this] { return !pending.empty(); });
+                fd = pending.front();
+                pending.pop_front();
+            }
+            serveConnection(fd, assembler);
+        }
+    }
+
+public:
+    explicit AssemblerServer(const std::string& path)
+        : socketPath(path), served(0), checkCache(std::make_shared<Assembler::CheckCache>()) {}
+    
+    // Não retorna enquanto o servidor estiver ativo (false se não puder escutar)
+    bool run(size_t threadCount) {
+        sockaddr_un address{};
+        if (socketPath.size() >= sizeof(address.sun_path)) {
+            std::cerr << "Erro: Caminho do socket muito longo: " << socketPath << std::endl;
+            return false;
+        }
+        address.sun_family = AF_UNIX;
+        std::strcpy(address.sun_path, socketPath.c_str());
+        
+        int listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd < 0) {
+            std::cerr << "Erro: Não foi possível criar o socket: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        ::unlink(socketPath.c_str());  // socket antigo de uma execução anterior
+        if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+            ::listen(listenFd, 128) < 0) {
+            std::cerr << "Erro: Não foi possível escutar em " << socketPath << ": " << std::strerror(errno) << std::endl;
+            ::close(listenFd);
+            return false;
+        }
+        
+        // Cliente que fecha a conexão no meio da resposta não derruba o servidor
+        std::signal(SIGPIPE, SIG_IGN);
+        
+        for (size_t i = 0; i < threadCount; i++) {
+            std::thread(&AssemblerServer::worker, this).detach();
+        }
+        std::cout << "Servidor de montagem em " << socketPath << " (" << threadCount << " threads)" << std::endl;
+        
+        for (;;) {
+            int fd = ::accept(listenFd, nullptr, nullptr);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) {
+                    continue;
+                }
+                std::cerr << "Erro: accept falhou: " << std::strerror(errno) << std::endl;
+                ::close(listenFd);
+                return false;
+            }
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                pending.push_back(fd);
+            }
+            queueReady.notify_one();
+        }
+    }
+    
+    // Lê o arquivo de entrada inteiro
+    static bool readSource(const std::string& inputFile, std::string& source) {
+        std::ifstream input(inputFile, std::ios::binary);
+        if (!input.is_open()) {
+            std::cerr << "Erro: Não foi possível abrir o arquivo de entrada: " << inputFile << std::endl;
+            return false;
+        }
+        std::ostringstream contents;
+        contents << input.rdbuf();
+        source = contents.str();
+        return true;
+    }
+    
+    // Cliente de --connect: envia o arquivo ao servidor e grava o .mif devolvido.
+    // image recebe a imagem montada, para --verify e --run.
+    static bool assembleRemote(const std::string& path, const std::string& inputFile, const std::string& outputFile,
+                               const std::vector<std::string>& options, bool quartus, MemoryImage& image) {
+        std::string source;
+        if (!readSource(inputFile, source)) {
+            return false;
+        }
+        
+        auto start = std::chrono::steady_clock::now();
+        int fd = connectTo(path);
+        if (fd < 0) {
+            return false;
+        }
+        
+        std::string request = "MONTAR " + std::to_string(source.size());
+        for (const std::string& option : options) {
+            request += " " + option;
+        }
+        request += "\n" + source;
+        
+        SocketReader reader(fd);
+        std::string header;
+        if (!writeAll(fd, request.data(), request.size()) || !reader.readLine(header, MAX_HEADER)) {
+            std::cerr << "Erro: Conexão encerrada pelo servidor" << std::endl;
+            ::close(fd);
+            return false;
+        }
+        
+        std::istringstream fields(header);
+        std::string status;
+        size_t segmentCount = 0;
+        size_t textLength = 0;
+        fields >> status;
+        if (status == "OK") {
+            fields >> segmentCount;
+        }
+        fields >> textLength;
+        
+        image.clear();
+        bool received = status == "OK" || status == "ERRO";
+        for (size_t k = 0; received && k < segmentCount; k++) {
+            std::string segmentHeader;
+            uint32_t base = 0;
+            size_t wordCount = 0;
+            received = reader.readLine(segmentHeader, MAX_HEADER) &&
+                       std::sscanf(segmentHeader.c_str(), "%x %zu", &base, &wordCount) == 2 &&
+                       wordCount <= MAX_SOURCE;
+            std::vector<unsigned char> bytes(received ? wordCount * 4 : 0);
+            received = received && reader.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+            for (size_t i = 0; received && i < wordCount; i++) {
+                image.append(base + static_cast<uint32_t>(i * 4),
+                             bytes[i * 4] | (bytes[i * 4 + 1] << 8) | (bytes[i * 4 + 2] << 16) |
+                             (static_cast<uint32_t>(bytes[i * 4 + 3]) << 24));
+            }
+        }
+        std::string text(textLength, '\0');
+        received = received && reader.read(&text[0], textLength);
+        ::close(fd);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        
+        std::cerr << text;
+        if (!received) {
+            std::cerr << "Erro: Resposta inválida do servidor" << std::endl;
+            return false;
+        }
+        if (status != "OK") {
+            return false;
+        }
+        
+        if (!image.write(outputFile, quartus)) {
+            return false;
+        }
+        std::cout << "Montagem concluída pelo servidor em " << std::fixed << std::setprecision(3)
+                  << (seconds * 1000.0) << " ms. Arquivo gerado: " << outputFile << std::endl;
+        return true;
+    }
+    
+    // Cliente de --check --connect: imprime o JSON devolvido pelo servidor.
+    // Retorna 0 sem diagnósticos, 1 com diagnósticos e 2 se a conexão falhar.
+    static int checkRemote(const std::string& path, const std::string& inputFile) {
+        std::string source;
+        if (!readSource(inputFile, source)) {
+            return 2;
+        }
+        int fd = connectTo(path);
+        if (fd < 0) {
+            return 2;
+        }
+        
+        std::string request = "VERIFICAR " + std::to_string(source.size()) + "\n" + source;
+        SocketReader reader(fd);
+        std::string header;
+        std::string status;
+        size_t count = 0;
+        size_t length = 0;
+        bool received = writeAll(fd, request.data(), request.size()) && reader.readLine(header, MAX_HEADER);
+        if (received) {
+            std::istringstream fields(header);
+            received = (fields >> status >> count >> length) && status == "OK" && length <= MAX_SOURCE;
+        }
+        std::string json(received ? length : 0, '\0');
+        received = received && reader.read(&json[0], length);
+        ::close(fd);
+        if (!received) {
+            std::cerr << "Erro: Resposta inválida do servidor" << std::endl;
+            return 2;
+        }
+        std::cout << json << std::endl;
+        return count == 0 ? 0 : 1;
+    }
+};
+#endif
+
+// Argumento numérico da linha de comando, sem exceções (como no ImmediateParser):
+// falso se text não for inteiro um número sem sinal de 64 bits
+static bool parseCount(const char* text, uint64_t& value) {
+    const char* end = text + std::strlen(text);
+    std::from_chars_result result = std::from_chars(text, end, value);
+    return text != end && result.ec == std::errc() && result.ptr == end;
+}
+
+int main(int argc, char* argv[]) {
+    std::string inputFile;
+    std::string outputFile = "memoria.mif";
+    bool outputGiven = false;
+    bool debugMode = false;
+    bool runMode = false;
+    bool verifyMode = false;
+    bool disasmMode = false;
+    bool fuzzMode = false;
+    bool hazardsMode = false;
+    bool scheduleMode = false;
+    bool lineTableMode = false;
+    bool quartusOutput = false;
+    bool compressMode = false;
+    bool cfgMode = false;
+    bool checkMode = false;
+    std::string traceFile;
+    std::string profileTrace;
+    std::string countsFile;
+    std::string layoutProfile;
+    std::string serveSocket;
+    std::string connectSocket;
+    size_t serveThreads = std::max(1u, std::thread::hardware_concurrency());
+    size_t profileTop = 20;
+    PipelineModel pipeline;
+    std::string pipelineSpec;
+    uint64_t maxSteps = 10000000000ULL;
+    uint64_t fuzzIterations = 10000000ULL;
+    uint64_t fuzzSeed = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+    
+    // Lê o valor numérico da opção arg em argv[++i]
+    auto countArgument = [&](int& i, const std::string& arg, uint64_t& value) {
+        if (!parseCount(argv[++i], value)) {
+            std::cerr << "Erro: Valor inválido para " << arg << ": '" << argv[i] << "' (esperado um número)" << std::endl;
+            return false;
+        }
+        return true;
+    };
+    
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        uint64_t count = 0;
+        if (arg == "-d") {
+            debugMode = true;
+        } else if (arg == "--run") {
+            runMode = true;
+        } else if (arg == "--max-steps" && i + 1 < argc) {
+            if (!countArgument(i, arg, maxSteps)) {
+                return 1;
+            }
+        } else if (arg == "--verify") {
+            verifyMode = true;
+        } else if (arg == "--disasm") {
+            disasmMode = true;
+        } else if (arg == "--fuzz") {
+            fuzzMode = true;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                if (!countArgument(i, arg, fuzzIterations)) {
+                    return 1;
+                }
+            }
+        } else if (arg == "--hazards") {
+            hazardsMode = true;
+        } else if (arg == "--schedule") {
+            scheduleMode = true;
+        } else if (arg == "--line-table") {
+            lineTableMode = true;
+        } else if (arg == "--quartus") {
+            quartusOutput = true;
+        } else if (arg == "--compress") {
+            compressMode = true;
+        } else if (arg == "--optimize-cfg") {
+            cfgMode = true;
+        } else if (arg == "--check") {
+            checkMode = true;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            traceFile = argv[++i];
+        } else if (arg == "--profile" && i + 1 < argc) {
+            profileTrace = argv[++i];
+        } else if (arg == "--counts" && i + 1 < argc) {
+            countsFile = argv[++i];
+        } else if (arg == "--layout-profile" && i + 1 < argc) {
+            layoutProfile = argv[++i];
+        } else if (arg == "--serve" && i + 1 < argc) {
+            serveSocket = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            if (!countArgument(i, arg, count)) {
+                return 1;
+            }
+            serveThreads = static_cast<size_t>(std::max<uint64_t>(1, count));
+        } else if (arg == "--connect" && i + 1 < argc) {
+            connectSocket = argv[++i];
+        } else if (arg == "--top" && i + 1 < argc) {
+            if (!countArgument(i, arg, count)) {
+                return 1;
+            }
+            profileTop = static_cast<size_t>(count);
+        } else if (arg == "--pipeline" && i + 1 < argc) {
+            pipelineSpec = argv[++i];
+            if (!pipeline.parse(pipelineSpec)) {
+                return 1;
+            }
+        } else if (arg == "--seed" && i + 1 < argc) {
+            if (!countArgument(i, arg, fuzzSeed)) {
+                return 1;
+            }
+        } else if (inputFile.empty()) {
+            inputFile = arg;
+        } else {
+            outputFile = arg;
+            outputGiven = true;
+        }
+    }
+    
+    if (fuzzMode) {
+        return EncoderFuzzer::runParallel(fuzzIterations, fuzzSeed) ? 0 : 1;
+    }
+    
+    if (!serveSocket.empty()) {
+#if defined(__unix__) || defined(__APPLE__)
+        AssemblerServer server(serveSocket);
+        return server.run(serveThreads) ? 0 : 1;
+#else
+        std::cerr << "Erro: --serve requer sockets Unix" << std::endl;
+        return 1;
+#endif
+    }
+    
+    if (inputFile.empty()) {
+        std::cerr << "Uso: " << argv[0] << " <arquivo_entrada.asm> [arquivo_saida.mif] [-d] [--run] [--max-steps N] [--verify]" << std::endl;
+        std::cerr << "       [--hazards] [--schedule] [--pipeline stages=5,forwarding=1,load-use=1,branch=2,jump=2]" << std::endl;
+        std::cerr << "       [--line-table] [--trace arquivo] [--quartus] [--compress] [--optimize-cfg]" << std::endl;
+        std::cerr << "       [--layout-profile contagens]" << std::endl;
+        std::cerr << "     " << argv[0] << " <arquivo_entrada.asm> --check [--connect <socket>]" << std::endl;
+        std::cerr << "     " << argv[0] << " <arquivo_entrada.mif> --disasm [arquivo_saida.asm]" << std::endl;
+        std::cerr << "     " << argv[0] << " --fuzz [N] [--seed S]" << std::endl;
+        std::cerr << "     " << argv[0] << " <tabela.lines> --profile <traço> [--top N] [--counts contagens]" << std::endl;
+        std::cerr << "     " << argv[0] << " --serve <socket> [--threads N]" << std::endl;
+        std::cerr << "     " << argv[0] << " <arquivo_entrada.asm> [arquivo_saida.mif] --connect <socket> [--schedule]" << std::endl;
+        std::cerr << "       [--compress] [--optimize-cfg] [--layout-profile contagens] [--pipeline ...] [--quartus]" << std::endl;
+        std::cerr << "       [--verify] [--run] [--max-steps N] [--trace arquivo]" << std::endl;
+        std::cerr << "  -d: Habilita o modo de depuração (mostra informações detalhadas)" << std::endl;
+        std::cerr << "  --run: Executa o programa montado no simulador myRV32I" << std::endl;
+        std::cerr << "  --max-steps N: Limite de instruções executadas no simulador" << std::endl;
+        std::cerr << "  --verify: Desmonta e remonta o programa, conferindo os bits" << std::endl;
+        std::cerr << "  --check: Só valida o fonte e imprime os diagnósticos em JSON (linha e coluna)" << std::endl;
+        std::cerr << "  --disasm: Desmonta um arquivo .mif (saída padrão se nenhum arquivo for dado)" << std::endl;
+        std::cerr << "  --hazards: Relatório estático de hazards do pipeline e estimativa de ciclos" << std::endl;
+        std::cerr << "  --schedule: Reordena instruções de cada bloco básico para esconder latências" << std::endl;
+        std::cerr << "  --pipeline: Parâmetros do modelo de pipeline usado por --run e --hazards" << std::endl;
+        std::cerr << "  --line-table: Grava a tabela endereço -> (arquivo, linha, rótulo) junto da saída (.lines)" << std::endl;
+        std::cerr << "  --trace: Grava o traço binário de PCs executados por --run" << std::endl;
+        std::cerr << "  --quartus: Grava o .mif no formato do Quartus mesmo sem .org" << std::endl;
+        std::cerr << "  --compress: Usa instruções comprimidas de 16 bits sempre que possível" << std::endl;
+        std::cerr << "  --optimize-cfg: Encadeia saltos e remove blocos inalcançáveis antes do layout" << std::endl;
+        std::cerr << "  --profile: Conta execuções por linha e rótulo a partir de um traço de PCs" << std::endl;
+        std::cerr << "  --counts: Grava as execuções por linha do --profile, para --layout-profile" << std::endl;
+        std::cerr << "  --layout-profile: Reordena os blocos básicos pelas contagens de execução (mais quentes em sequência)" << std::endl;
+        std::cerr << "  --serve: Mantém um montador residente respondendo requisições no socket Unix" << std::endl;
+        std::cerr << "  --connect: Monta pelo servidor iniciado com --serve" << std::endl;
+        std::cerr << "  --fuzz N: Testa os codificadores com N instruções aleatórias (padrão: 10^7)" << std::endl;
+        return 1;
+    }
+    
+    if (!profileTrace.empty()) {
+        TraceProfiler profiler;
+        if (!profiler.loadTable(inputFile) || !profiler.processTrace(profileTrace)) {
+            return 1;
+        }
+        profiler.printReport(profileTop);
+        if (!countsFile.empty()) {
+            if (!profiler.writeLineCounts(countsFile)) {
+                return 1;
+            }
+            std::cout << std::endl << "Contagens por linha gravadas: " << countsFile << std::endl;
+        }
+        return 0;
+    }
+    
+    if (checkMode) {
+#if defined(__unix__) || defined(__APPLE__)
+        if (!connectSocket.empty()) {
+            return AssemblerServer::checkRemote(connectSocket, inputFile);
+        }
+#endif
+        std::ifstream input(inputFile, std::ios::binary);
+        if (!input.is_open()) {
+            std::cerr << "Erro: Não foi possível abrir o arquivo de entrada: " << inputFile << std::endl;
+            return 2;
+        }
+        std::ostringstream contents;
+        contents << input.rdbuf();
+        
+        Assembler assembler(inputFile, "");
+        std::vector<Assembler::Diagnostic> diagnostics = assembler.check(contents.str());
+        std::cout << Assembler::diagnosticsJson(diagnostics) << std::endl;
+        return diagnostics.empty() ? 0 : 1;
+    }
+    
+    if (disasmMode) {
+        MemoryImage image;
+        if (!MemoryImage::read(inputFile, image)) {
+            return 1;
+        }
+        
+        Disassembler disassembler;
+        auto start = std::chrono::steady_clock::now();
+        std::string text = disassembler.disassembleProgram(image);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        
+        if (!outputGiven) {
+            std::cout << text;
+            return 0;
+        }
+        
+        std::ofstream file(outputFile);
+        if (!file.is_open()) {
+            std::cerr << "Erro: Não foi possível abrir o arquivo de saída: " << outputFile << std::endl;
+            return 1;
+        }
+        file << text;
+        std::cout << "Desmontagem concluída: " << image.wordCount() << " palavras em " << std::fixed
+                  << std::setprecision(3) << (seconds * 1000.0) << " ms. Arquivo gerado: " << outputFile << std::endl;
+        return 0;
+    }
+    
+    // Conferência e execução da imagem montada, local ou pelo servidor
+    auto verifyAndRun = [&](const MemoryImage& image) -> int {
+        if (verifyMode) {
+            Disassembler disassembler;
+            if (!disassembler.verify(image)) {
+                return 1;
+            }
+        }
+        
+        if (runMode) {
+            Simulator simulator(pipeline);
+            if (!simulator.load(image)) {
+                return 1;
+            }
+            
+            std::FILE* trace = nullptr;
+            if (!traceFile.empty()) {
+                trace = std::fopen(traceFile.c_str(), "wb");
+                if (!trace) {
+                    std::cerr << "Erro: Não foi possível abrir o arquivo de traço: " << traceFile << std::endl;
+                    return 1;
+                }
+                simulator.setTraceFile(trace);
+            }
+            std::cout << "Executando no simulador..." << std::endl;
+            Simulator::StopReason reason = simulator.run(maxSteps);
+            if (trace) {
+                std::fclose(trace);
+            }
+            simulator.printReport();
+            if (reason == Simulator::STOP_INVALID_INSTRUCTION || reason == Simulator::STOP_MEMORY_FAULT ||
+                reason == Simulator::STOP_PC_OUT_OF_RANGE) {
+                return 1;
+            }
+        }
+        return 0;
+    };
+    
+    if (!connectSocket.empty()) {
+#if defined(__unix__) || defined(__APPLE__)
+        // O servidor devolve só a imagem: o que precisa das instruções fica local
+        if (debugMode || lineTableMode || hazardsMode) {
+            std::cerr << "Erro: -d, --line-table e --hazards não podem ser usados com --connect" << std::endl;
+            return 1;
+        }
+        std::vector<std::string> options;
+        if (scheduleMode) {
+            options.push_back("escalonar");
+        }
+        if (compressMode) {
+            options.push_back("comprimir");
+        }
+        if (cfgMode) {
+            options.push_back("otimizar-cfg");
+        }
+        if (!layoutProfile.empty()) {
+            // O servidor lê o perfil a partir do seu próprio diretório
+            std::string profilePath = layoutProfile;
+            if (char* resolved = realpath(layoutProfile.c_str(), nullptr)) {
+                profilePath = resolved;
+                free(resolved);
+            }
+            options.push_back("perfil=" + profilePath);
+        }
+        if (!pipelineSpec.empty()) {
+            options.push_back("pipeline=" + pipelineSpec);
+        }
+        MemoryImage image;
+        if (!AssemblerServer::assembleRemote(connectSocket, inputFile, outputFile, options, quartusOutput, image)) {
+            return 1;
+        }
+        return verifyAndRun(image);
+#else
+        std::cerr << "Erro: --connect requer sockets Unix" << std::endl;
+        return 1;
+#endif
+    }
+    
+    Assembler assembler(inputFile, outputFile);
+    
+    if (debugMode) {
+        std::cout << "Modo de depuração ativado" << std::endl;
+        assembler.setDebugMode(true);
+    }
+    if (scheduleMode) {
+        assembler.enableScheduling(pipeline);
+    }
+    assembler.setQuartusOutput(quartusOutput);
+    assembler.setCompression(compressMode);
+    assembler.setCfgOptimization(cfgMode);
+    if (!layoutProfile.empty() && !assembler.loadLayoutProfile(layoutProfile)) {
+        return 1;
+    }
+    
+    if (!assembler.assemble()) {
+        std::cerr << "Erro durante o processo de montagem." << std::endl;
+        return 1;
+    }
+    std::cout << "Montagem concluída com sucesso! Arquivo gerado: " << outputFile << std::endl;
+    
+    if (lineTableMode) {
+        // Mesmo nome da saída, com extensão .lines
+        size_t dot = outputFile.find_last_of('.');
+        size_t slash = outputFile.find_last_of("/\\");
+        std::string tablePath = (dot != std::string::npos && (slash == std::string::npos || dot > slash))
+            ? outputFile.substr(0, dot) + ".lines" : outputFile + ".lines";
+        if (!assembler.writeLineTable(tablePath)) {
+            return 1;
+        }
+        std::cout << "Tabela de linhas gerada: " << tablePath << std::endl;
+    }
+    
+    if (hazardsMode) {
+        HazardAnalyzer analyzer(pipeline, assembler.getInstructions(), assembler.analyzeInstructions(),
+                                assembler.getSymbolTable());
+        analyzer.analyze();
+        analyzer.printReport();
+    }
+    
+    return verifyAndRun(assembler.getImage());
+}